@@ -79,6 +79,10 @@ namespace wex
     /// Of course, you could also do: addressrange(96,99).Sort().
     /// If you did not specify an address range,
     /// the command is run as an asynchronous process.
+    /// In visual mode the range is piped to the stdin of the command
+    /// (as vi does), so a command that does not read stdin (e.g. ls -l)
+    /// replaces the range with its output. In ex mode the range is
+    /// written to a temp file, and the filename is passed as argument.
     bool escape(const std::string& command);
 
     /// Executes register on this range.
@@ -169,12 +173,15 @@ namespace wex
     const std::string build_replacement(const std::string& text) const;
     int
     confirm(const std::string& pattern, const std::string& replacement) const;
+    bool escape_filter(const std::string& command) const;
     bool general(const address& destination, std::function<bool()> f) const;
     bool indent(bool forward = true) const;
     void set(const std::string& begin, const std::string& end);
     void set(int begin, int end);
     void set(address& begin, address& end, int lines) const;
     bool set_selection() const;
+    bool
+    substitute_single_pass(const data::substitute& data, int search_flags);
 
     static inline data::substitute m_substitute;
 
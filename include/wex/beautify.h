@@ -35,8 +35,10 @@ public:
   /// Returns default beautifiers.
   config::strings_t list() const;
 
-  /// Beautifies the specified stc component.
-  /// Return false if it did not succeed.
+  /// Beautifies the specified stc component, using its filter.
+  /// The beautifier runs asynchronously, and the text is replaced
+  /// when it is finished, unless the text was changed meanwhile.
+  /// Return false if the beautifier could not be started.
   bool stc(wex::stc& s) const;
 
 private:
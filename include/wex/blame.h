@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include <memory>
 #include <pugixml.hpp>
+#include <regex>
+#include <unordered_map>
 #include <wex/lexers.h>
 
 namespace wex
@@ -16,6 +19,9 @@ namespace wex
 /// using the xml_node constructor (see wex-menus.xml),
 /// the kind of info returned by get is configurable using
 /// blame_get_author, blame_get_id, blame_get_date.
+/// The blame format is compiled once, and the date of each commit
+/// is parsed once (for a limited number of dates), so getting the info
+/// for all lines of a blame output is fast.
 class blame
 {
 public:
@@ -45,5 +51,12 @@ private:
   std::string m_blame_format, m_date_format;
 
   size_t m_date_print{10};
+
+  // shared, as a blame is copied with its vcs entry,
+  // the regex is not changed by matching
+  std::shared_ptr<const std::regex> m_regex;
+
+  // the parsed time for each date text
+  mutable std::unordered_map<std::string, std::tuple<bool, time_t>> m_times;
 };
 }; // namespace wex
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      csv-writer.h
+// Purpose:   Declaration of wex::csv_writer class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wex/data/csv.h>
+#include <wex/path.h>
+
+class wxFileOutputStream;
+class wxZlibOutputStream;
+
+namespace wex
+{
+/// Writes rows of values to a file, as specified by the csv data.
+/// The rows are buffered, and written when the buffer is full.
+class csv_writer
+{
+public:
+  /// Constructor, creates the file.
+  csv_writer(const path& p, const data::csv& data);
+
+  /// Destructor, closes the file.
+  ~csv_writer();
+
+  /// Adds a value to the current row.
+  /// Using QUOTE_NONE a backslash, the delimiter, CR or LF in the value
+  /// is escaped using a backslash (as \\, \t, \r, \n, or a backslash
+  /// followed by the delimiter), so each row stays on one line.
+  void add(const std::string_view& value);
+
+  /// Returns number of bytes written, before compression.
+  auto bytes() const { return m_bytes; }
+
+  /// Writes the buffer and closes the file.
+  /// Returns false if writing failed.
+  bool close();
+
+  /// Ends the current row.
+  void end_row();
+
+  /// Writes the column names as a row, if a header is wanted.
+  void header(const std::vector<std::string>& cols);
+
+  /// Returns true if no error occurred.
+  bool is_ok() const { return m_is_ok; }
+
+private:
+  bool flush();
+
+  const data::csv   m_data;
+  const std::string m_special;
+
+  std::unique_ptr<wxFileOutputStream> m_file;
+  std::unique_ptr<wxZlibOutputStream> m_zlib;
+
+  std::string m_buffer;
+  size_t      m_bytes{0};
+  bool        m_first{true}, m_is_ok{false};
+};
+}; // namespace wex
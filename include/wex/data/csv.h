@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      data/csv.h
+// Purpose:   Declaration of class wex::data::csv
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace wex::data
+{
+/// Offers data to be used when writing delimiter separated values,
+/// default as csv, use a tab delimiter and QUOTE_NONE for tsv.
+class csv
+{
+public:
+  /// quoting values.
+  enum quoting_t
+  {
+    QUOTE_MINIMAL, // quote values containing delimiter, quote or newline
+    QUOTE_ALL,     // quote all values
+    QUOTE_NONE,    // never quote, escape delimiter, newline using backslash
+  };
+
+  /// Returns delimiter.
+  auto delimiter() const { return m_delimiter; }
+
+  /// Sets delimiter.
+  csv& delimiter(char rhs)
+  {
+    m_delimiter = rhs;
+    return *this;
+  }
+
+  /// Returns whether output is compressed using gzip.
+  auto gzip() const { return m_gzip; }
+
+  /// Sets gzip.
+  csv& gzip(bool rhs)
+  {
+    m_gzip = rhs;
+    return *this;
+  }
+
+  /// Returns whether a header with the column names is written.
+  auto header() const { return m_header; }
+
+  /// Sets header.
+  csv& header(bool rhs)
+  {
+    m_header = rhs;
+    return *this;
+  }
+
+  /// Returns quote.
+  auto quote() const { return m_quote; }
+
+  /// Sets quote, a quote in a quoted value is doubled.
+  csv& quote(char rhs)
+  {
+    m_quote = rhs;
+    return *this;
+  }
+
+  /// Returns quoting.
+  auto quoting() const { return m_quoting; }
+
+  /// Sets quoting.
+  csv& quoting(quoting_t rhs)
+  {
+    m_quoting = rhs;
+    return *this;
+  }
+
+private:
+  char      m_delimiter{','}, m_quote{'"'};
+  bool      m_gzip{false}, m_header{true};
+  quoting_t m_quoting{QUOTE_MINIMAL};
+};
+}; // namespace wex::data
@@ -45,11 +45,16 @@ public:
   /// Returns the flags.
   const auto& flags() const { return m_flags; }
 
+  /// Returns true if debugger stdout is GDB/MI output, that is
+  /// interpreted using a mi_parser instead of the regexes.
+  bool is_mi() const { return m_is_mi; }
+
   /// Returns the regex for interpreting debug stdout.
   std::string regex_stdout(regex_t r) const;
 
 private:
   std::string m_break_del, m_break_set, m_extensions, m_flags;
+  bool        m_is_mi;
   std::map<regex_t, std::string> m_regex_stdouts;
 };
 }; // namespace wex
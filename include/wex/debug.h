@@ -12,6 +12,7 @@
 #include <tuple>
 #include <wex/debug-entry.h>
 #include <wex/marker.h>
+#include <wex/mi-parser.h>
 #include <wex/path.h>
 
 namespace wex
@@ -76,6 +77,10 @@ public:
   bool toggle_breakpoint(int line, stc* stc);
 
 private:
+  bool add_breakpoint(
+    const std::string& no,
+    const std::string& file,
+    int                line);
   bool allow_open(const path& p) const;
 
   bool clear_breakpoints(const std::string& text);
@@ -84,9 +89,12 @@ private:
 
   path complete_path(const std::string& text) const;
   void is_finished();
+  void process_mi(const std::string& text);
   void process_stdin(const std::string& text);
   void process_stdout(const std::string& text);
   void set_entry(const std::string& debugger);
+  void set_exe(const std::string& text);
+  bool show_variable(const std::string& text);
 
   const marker m_marker_breakpoint = wex::marker(2);
 
@@ -101,6 +109,7 @@ private:
   frame*                 m_frame;
   wex::debug_entry       m_entry;
   wex::factory::process* m_process{nullptr};
+  mi_parser              m_mi;
   std::string            m_stdout;
 };
 }; // namespace wex
@@ -57,7 +57,7 @@ private:
   void do_file_new() final;
   void do_file_save(bool save_as = false) final;
 
-  void on_idle(wxIdleEvent& event);
+  void watch_project();
 
   bool m_contents_changed = false;
 
@@ -10,9 +10,11 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <wex/ex-command.h>
+#include <wex/macro-command.h>
 #include <wex/marker.h>
 
 namespace wex
@@ -22,6 +24,7 @@ class ex_stream;
 class macros;
 class macro_mode;
 class frame;
+class regex;
 
 enum class info_message_t
 {
@@ -80,6 +83,14 @@ public:
   /// Returns true if the command was executed.
   virtual bool command(const std::string& command);
 
+  /// Executes a compiled macro command.
+  /// Returns true if the command was executed.
+  virtual bool command(const macro_command& command);
+
+  /// Compiles a command for macro playback.
+  /// See macro_command.
+  virtual const macro_command compile(const std::string& command) const;
+
   /// Other methods.
 
   /// Returns calculated value of text.
@@ -177,7 +188,17 @@ private:
     std::string& range,
     std::string& cmd,
     address_t&   type);
+  bool address_split(
+    std::string& text,
+    std::string& range,
+    std::string& cmd,
+    address_t&   type) const;
   bool command_address(const std::string& command);
+  bool command_address(
+    address_t          type,
+    const std::string& range,
+    const std::string& cmd,
+    std::string&       rest);
   bool command_handle(const std::string& command) const;
   bool command_set(const std::string& command);
 
@@ -188,7 +209,7 @@ private:
     const T*                                                    container,
     std::function<bool(const std::string&, const std::string&)> cb);
 
-  void info_message(const std::string& text, info_message_t type) const;
+  void info_message(const std::string_view& text, info_message_t type) const;
 
   template <typename S, typename T>
   std::string report_container(const T& container) const;
@@ -214,6 +235,7 @@ private:
 
   wex::ctags* m_ctags;
   wex::frame* m_frame;
+  wex::regex* m_address_regex{nullptr};
 
   class ex_stream* m_ex_stream{nullptr};
 
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      factory/executor.h
+// Purpose:   Declaration of class wex::factory::executor
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace wex
+{
+  namespace factory
+  {
+    class executor_imp;
+    class executor_job;
+
+    /// This class offers a process executor for short running tools
+    /// (vcs, beautifiers, ctags, filters).
+    /// The pipes of all processes are serviced by one (epoll based) io loop,
+    /// run by a fixed set of threads, instead of threads per pipe.
+    /// The number of concurrent children is capped, excess work is queued,
+    /// and timing statistics are kept per tool.
+    /// Input is piped to the processes, so SIGPIPE should be ignored
+    /// (as app::OnInit does), for processes that do not read all input.
+    class executor
+    {
+    public:
+      /// Callback with exit code, stdout and stderr.
+      typedef std::function<
+        void(int ec, const std::string& out, const std::string& err)>
+        callback_t;
+
+      /// A submitted job.
+      typedef std::shared_ptr<executor_job> job_t;
+
+      /// Timing statistics for a tool.
+      struct timing
+      {
+        /// Number of finished processes.
+        size_t count{0};
+
+        /// Number of processes with a nonzero exit code.
+        size_t failed{0};
+
+        /// Total run time.
+        std::chrono::microseconds total{0};
+
+        /// Maximum run time.
+        std::chrono::microseconds max{0};
+      };
+
+      /// Static interface.
+
+      /// Returns the executor.
+      static executor* get(bool createOnDemand = true);
+
+      /// Sets the object as the current one, returns the pointer
+      /// to the previous current object (both the parameter and
+      /// returned value may be nullptr).
+      static executor* set(executor* executor);
+
+      /// Other methods.
+
+      /// Constructor.
+      executor(
+        /// number of io threads
+        size_t threads = 2,
+        /// max number of concurrent children,
+        /// 0 uses the hardware concurrency
+        size_t max_children = 0);
+
+      /// Destructor, removes queued jobs, and terminates running children.
+      ~executor();
+
+      /// Cancels a job. A queued job is removed, a running child
+      /// is terminated. The callback is invoked with a nonzero exit code.
+      void cancel(const job_t& job);
+
+      /// Returns max number of concurrent children.
+      size_t get_max_children() const;
+
+      /// Returns number of queued jobs.
+      size_t get_queued() const;
+
+      /// Returns number of running children.
+      size_t get_running() const;
+
+      /// Returns the timing statistics, the key is the tool
+      /// (filename of the first word of the command).
+      std::map<std::string, timing> get_timings() const;
+
+      /// Submits a job, and returns immediately. The process is started
+      /// as soon as less than max children are running.
+      /// The callback is invoked once, from an executor thread,
+      /// so it should not block, nor submit and wait for another job.
+      job_t submit(
+        /// the command
+        const std::string& exe,
+        /// text to be piped to stdin
+        const std::string& input,
+        /// the callback
+        callback_t f,
+        /// the working directory
+        const std::string& start_dir = std::string());
+
+      /// Runs a process directly and waits for it to finish.
+      /// The process is not queued, and not counted against max children,
+      /// so it does not wait for submitted jobs, and it can be invoked
+      /// from a callback. Returns the exit code.
+      int system(
+        /// the command
+        const std::string& exe,
+        /// text to be piped to stdin
+        const std::string& input,
+        /// receives stdout
+        std::string& out,
+        /// receives stderr
+        std::string& err,
+        /// the working directory
+        const std::string& start_dir = std::string());
+
+    private:
+      std::unique_ptr<executor_imp> m_imp;
+
+      static executor* m_self;
+    };
+  }; // namespace factory
+};   // namespace wex
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      factory/filter.h
+// Purpose:   Declaration of class wex::factory::filter
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace wex
+{
+  namespace factory
+  {
+    class filter_state;
+
+    /// This class offers a filter: text is piped to the stdin of
+    /// a process, while its stdout and stderr are read concurrently,
+    /// so no temp files are used.
+    class filter
+    {
+    public:
+      /// Callback for an async filter, with exit code, stdout and stderr.
+      typedef std::function<
+        void(int ec, const std::string& out, const std::string& err)>
+        callback_t;
+
+      /// Destructor, cancels a running async filter.
+      ~filter();
+
+      /// Submits the filter to the executor, and returns immediately.
+      /// When the process is finished, and the filter was not cancelled,
+      /// the callback is invoked from the main thread.
+      /// A running async filter is cancelled first.
+      /// Returns true if the filter is submitted.
+      bool async_system(
+        /// the command
+        const std::string& exe,
+        /// text to be piped to stdin
+        const std::string& input,
+        /// the callback
+        callback_t f,
+        /// the working directory
+        const std::string& start_dir = std::string());
+
+      /// Cancels a running async filter, the process is terminated,
+      /// and the callback is not invoked.
+      void cancel();
+
+      /// Returns the stderr (of the sync filter).
+      const auto& get_stderr() const { return m_stderr; }
+
+      /// Returns the stdout (of the sync filter).
+      const auto& get_stdout() const { return m_stdout; }
+
+      /// Returns true if an async filter is running.
+      bool is_running() const;
+
+      /// Runs the filter and waits for it to finish.
+      /// Returns the exit code.
+      int system(
+        /// the command
+        const std::string& exe,
+        /// text to be piped to stdin
+        const std::string& input,
+        /// the working directory
+        const std::string& start_dir = std::string());
+
+    private:
+      std::shared_ptr<filter_state> m_state;
+      std::string                   m_stderr, m_stdout;
+    };
+  }; // namespace factory
+};   // namespace wex
@@ -71,7 +71,8 @@ namespace wex
       // Stops the async process.
       bool stop();
 
-      /// Runs the sync process, collecting output in stdout and stderr.
+      /// Runs the sync process directly (see executor::system),
+      /// collecting output in stdout and stderr.
       /// It will execute the process and wait for it's exit,
       /// then return the exit_code.
       int system(
@@ -79,6 +80,13 @@ namespace wex
         const std::string& start_dir = std::string());
 
     protected:
+      /// Sets exe, stdout and stderr, as if system was invoked,
+      /// e.g. for a process that was run by the executor.
+      void set_system(
+        const std::string& exe,
+        const std::string& out,
+        const std::string& err);
+
       std::string m_exe;
 
     private:
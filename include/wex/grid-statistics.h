@@ -9,10 +9,12 @@
 
 #include <wex/grid.h>
 #include <wex/statistics.h>
+#include <wx/timer.h>
 
 namespace wex
 {
 /// Offers a class to show statistics on a grid.
+/// Changed values are shown at a fixed rate, not on each change.
 template <class T>
 class grid_statistics
   : public grid
@@ -25,6 +27,7 @@ public:
     const data::window& data = data::window().style(wxWANTS_CHARS))
     : statistics<T>(v)
     , grid(data)
+    , m_timer(this)
   {
     Bind(
       wxEVT_MENU,
@@ -34,6 +37,14 @@ public:
       },
       wxID_CLEAR);
 
+    Bind(
+      wxEVT_TIMER,
+      [=, this](wxTimerEvent& event)
+      {
+        update();
+      },
+      m_timer.GetId());
+
     CreateGrid(0, 0);
     AppendCols(2);
     EnableEditing(false);
@@ -45,6 +56,7 @@ public:
   {
     statistics<T>::clear();
     m_keys.clear();
+    m_timer.Stop();
 
     ClearGrid();
 
@@ -57,14 +69,18 @@ public:
   /// Returns keys.
   const auto& get_keys() const { return m_keys; }
 
-  /// Sets key to value, and refreshes grid.
+  /// Sets key to value. A new key is added to the grid,
+  /// other values are shown when the grid is updated.
   const T set(const std::string& key, T value) override
   {
     statistics<T>::set(key, value);
 
-    if (const auto& it = m_keys.find(key); it != m_keys.end())
+    if (m_keys.contains(key))
     {
-      SetCellValue(it->second, 1, std::to_string(value));
+      if (!m_timer.IsRunning())
+      {
+        m_timer.StartOnce(update_rate);
+      }
     }
     else
     {
@@ -77,10 +93,9 @@ public:
       SetCellValue(row, 1, std::to_string(value));
 
       AutoSizeColumn(0);
+      ForceRefresh();
     }
 
-    ForceRefresh();
-
     return value;
   };
 
@@ -139,6 +154,24 @@ protected:
   };
 
 private:
+  // Shows all values.
+  void update()
+  {
+    for (const auto& it : m_keys)
+    {
+      SetCellValue(
+        it.second,
+        1,
+        std::to_string(statistics<T>::get(it.first)));
+    }
+
+    ForceRefresh();
+  }
+
+  // The rate in milliseconds at which changed values are shown.
+  static constexpr int update_rate = 250;
+
   std::map<std::string, int> m_keys;
+  wxTimer                    m_timer;
 };
 }; // namespace wex
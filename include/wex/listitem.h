@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <wex/listview.h>
 #include <wex/path.h>
 
@@ -25,9 +26,19 @@ public:
     const path&        filename,
     const std::string& filespec = std::string());
 
+  /// Constructor, using a path string, no stat is done
+  /// until the path is used.
+  listitem(
+    listview*          listview,
+    const std::string& filename,
+    const std::string& filespec = std::string());
+
   // Deletes this item from the listview.
   void erase() { m_listview->DeleteItem(GetId()); }
 
+  /// Returns the path string, without a stat.
+  const auto& file() const { return m_file; }
+
   /// Returns the file spec.
   const auto file_spec() const { return m_file_spec; }
 
@@ -35,7 +46,9 @@ public:
   auto* get_listview() const { return m_listview; }
 
   /// Inserts the item at index (if -1 at the end of the listview),
-  /// and sets all attributes.
+  /// and sets all attributes. For a file listview only the name and
+  /// folder are set from the path string, without a stat, the other
+  /// attributes are set in the background.
   void insert(long index = -1);
 
   /// Returns true if this item is readonly (on the listview).
@@ -44,8 +57,8 @@ public:
   /// Logs info about this item.
   std::stringstream log() const;
 
-  /// Returns the path.
-  const auto& path() const { return m_path; }
+  /// Returns the path, its stat is synced when first used.
+  const wex::path& path() const;
 
   /// Sets the item text using column name.
   /// Returns false if text could not be set.
@@ -61,8 +74,9 @@ private:
   // and cannot be const, as it calls insert_item on the list.
   listview* m_listview;
 
-  const wex::path   m_path;
-  const std::string m_file_spec;
+  const std::string m_file, m_file_spec;
   bool              m_is_readonly;
+
+  mutable std::shared_ptr<wex::path> m_path;
 };
 }; // namespace wex
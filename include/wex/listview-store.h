@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-store.h
+// Purpose:   Declaration of class wex::listview_store
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wex
+{
+/// Offers a columnar store for the rows of a virtual listview.
+/// The text of all cells is kept in one text arena, and a cell is
+/// an offset and length into that arena. A cell equal to the cell
+/// on the row above shares its text, so e.g. the file name and folder
+/// of subsequent find results for the same file are stored once.
+/// For each row a 256 bit signature of the (hashed) case folded character
+/// pairs of its cells is kept. It is a prefilter, like a bloom filter:
+/// find still visits all rows, but skips reading the text of a row if its
+/// signature lacks a pair of the text to find. For rows with much text
+/// most bits are set, and these rows are always compared.
+/// It is not an index, and native (not virtual) listviews do not use it.
+class listview_store
+{
+public:
+  /// Appends a column, with empty cells for existing rows.
+  void append_column();
+
+  /// Clears all rows.
+  void clear();
+
+  /// Returns number of columns.
+  size_t columns() const { return m_cells.size(); }
+
+  /// Erases rows, the row numbers do not need to be sorted.
+  void erase(std::vector<size_t> rows);
+
+  /// Returns the first row from start (forward or backward) with a cell
+  /// containing text, or -1 if there is no such row.
+  long find(
+    /// the text to find
+    const std::string& text,
+    /// the row to start with
+    long start,
+    /// direction
+    bool forward = true,
+    /// if false, text is compared case insensitive
+    bool match_case = false,
+    /// if true, text must match the complete cell
+    bool match_cell = false) const;
+
+  /// Returns the rows (taken from rows, in the same order) with a cell
+  /// containing text, all rows if text is empty.
+  std::vector<size_t> find_all(
+    const std::string&         text,
+    const std::vector<size_t>& rows,
+    bool                       match_case = false) const;
+
+  /// Returns the text of a cell, or an empty view if row or col is invalid.
+  /// The view is valid until the store is modified.
+  std::string_view get(size_t row, size_t col) const;
+
+  /// Returns the data of a row (e.g. readonly state).
+  long get_data(size_t row) const
+  {
+    return row < m_data.size() ? m_data[row] : 0;
+  }
+
+  /// Returns the image of a row.
+  int get_image(size_t row) const
+  {
+    return row < m_image.size() ? m_image[row] : -1;
+  }
+
+  /// Inserts a row with cells (missing cells are empty), before index,
+  /// or appends it if index is -1. Returns the row number.
+  size_t insert(const std::vector<std::string>& cells, long index = -1);
+
+  /// Returns number of bytes used by the store.
+  size_t memory() const;
+
+  /// Reorders the rows, the new row i is the old row order[i].
+  void reorder(const std::vector<size_t>& order);
+
+  /// Sets the text of a cell.
+  /// Returns false if row or col is invalid.
+  bool set(size_t row, size_t col, const std::string& text);
+
+  /// Sets the data of a row.
+  void set_data(size_t row, long data)
+  {
+    if (row < m_data.size())
+      m_data[row] = data;
+  }
+
+  /// Sets the image of a row.
+  void set_image(size_t row, int image)
+  {
+    if (row < m_image.size())
+      m_image[row] = image;
+  }
+
+  /// Returns the number of rows.
+  size_t size() const { return m_data.size(); }
+
+private:
+  // A cell is an offset (high 40 bits) and length (low 24 bits)
+  // into the arena.
+  typedef uint64_t cell_t;
+
+  // A bit for each (hashed) case folded character pair.
+  typedef std::array<uint64_t, 4> signature_t;
+
+  // A text to find, with its case folded text and signature.
+  struct needle
+  {
+    needle(const std::string& text, bool match_case, bool match_cell);
+
+    const std::string text;
+    std::string       folded;
+    signature_t       signature{};
+    const bool        match_case, match_cell;
+  };
+
+  cell_t add(const std::string& text, size_t row, size_t col);
+  void   compact();
+  bool   is_match(size_t row, const needle& n) const;
+  bool   is_shared(size_t row, size_t col) const;
+  size_t length(cell_t cell) const { return cell & 0xFFFFFF; }
+  void   sign(size_t row);
+
+  std::string                      m_arena;
+  // The bytes no longer used, an estimate, as is_shared only sees
+  // adjacent rows, and after a reorder shared cells can be apart.
+  // It only decides when to compact, and compact ignores it.
+  size_t                           m_garbage{0};
+  std::vector<std::vector<cell_t>> m_cells; // for each column, the rows
+  std::vector<long>                m_data;
+  std::vector<int>                 m_image;
+  std::vector<signature_t>         m_signature;
+};
+}; // namespace wex
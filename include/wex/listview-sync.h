@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-sync.h
+// Purpose:   Declaration of wex::listview_sync class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wex/path.h>
+
+class wxFileSystemWatcher;
+class wxFileSystemWatcherEvent;
+
+namespace wex
+{
+class listview;
+
+/// Synchronizes the items of a listview with the files they refer to,
+/// using file system notifications for the folders of these files.
+/// Only the items that refer to a changed file are updated.
+class listview_sync
+{
+public:
+  /// Constructor.
+  explicit listview_sync(listview* lv);
+
+  /// Destructor.
+  ~listview_sync();
+
+  /// Invoke when items are inserted or deleted, the index and watched
+  /// folders are updated after the current event is handled,
+  /// folders that no longer have items are no longer watched.
+  void changed();
+
+  /// Returns the watched folders.
+  const auto& dirs() const { return m_dirs; }
+
+  /// Watches a file, the callback is invoked when it is changed.
+  void watch(const path& p, std::function<void()> f);
+
+private:
+  // The items referring to a file, and the last known stat of the file.
+  struct entry
+  {
+    std::vector<long> items;
+    time_t            mtime{0};
+    bool              readonly{false};
+  };
+
+  bool add(const std::string& dir);
+  void on_event(wxFileSystemWatcherEvent& event);
+  void rebuild();
+  void sync(const std::string& file);
+
+  listview* m_listview;
+
+  std::unique_ptr<wxFileSystemWatcher>         m_watcher;
+  std::unordered_map<std::string, entry>       m_entries;
+  std::map<std::string, std::function<void()>> m_files;
+  std::set<std::string>                        m_dirs;
+
+  bool m_pending{false}, m_updated{false};
+};
+}; // namespace wex
@@ -7,13 +7,16 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <wex/data/listview.h>
 #include <wex/factory/listview.h>
+#include <wex/listview-store.h>
 #include <wex/path-match.h>
 
 #include <wx/artprov.h> // for wxArtID
@@ -22,14 +25,25 @@ namespace wex
 {
 class frame;
 class item_dialog;
+class listview_filter;
+class listview_meta;
+class listview_sync;
 class menu;
 
 /// Adds printing, popup menu, images, columns and items to wxListView.
 /// Allows for sorting on any column.
 /// Adds some standard lists, all these lists
 /// have items associated with files or folders.
+/// If the window style contains wxLC_VIRTUAL (default for the FIND list),
+/// the items are kept in a listview_store, and their text is
+/// provided when the item is shown, and the items can be filtered.
+/// For the FILE and HISTORY lists the items are inserted with their name,
+/// the other attributes are set afterwards from worker threads.
 class listview : public factory::listview
 {
+  friend class listitem;
+  friend class listview_meta;
+
 public:
   /// Shows a dialog with options, returns dialog return code.
   /// If used modeless, it uses the dialog id as specified,
@@ -39,6 +53,9 @@ public:
   /// Default constructor.
   explicit listview(const data::listview& data = data::listview());
 
+  /// Destructor.
+  ~listview() override;
+
   /// Virtual interface
 
   /// Inserts new item with column values from text.
@@ -51,7 +68,8 @@ public:
   virtual const std::string item_to_text(long item_number) const;
 
   /// Implement this one if you have images that might
-  /// be changed after sorting etc.
+  /// be changed after deleting items or changing the config.
+  /// Sorting keeps the images and item data.
   virtual void items_update();
 
   /// Other methods
@@ -68,6 +86,16 @@ public:
   /// Returns the field separator.
   const auto& field_separator() const { return m_field_separator; }
 
+  /// Filters the items of a virtual listview, only the items matching
+  /// text are shown, an empty text shows all items again.
+  /// The text is a column name followed by = != < <= > or >= and a value,
+  /// a regex (if find replace data uses regex) for the Line column,
+  /// a glob (containing * or ?) for the path, or a text one of
+  /// the columns should contain.
+  /// Sorting sorts the shown items, inserting items removes the filter.
+  /// Returns false if this is not a virtual listview, or text is invalid.
+  bool filter(const std::string& text);
+
   /// If column is not found, -1 is returned,
   int find_column(const std::string& name) const
   {
@@ -89,6 +117,12 @@ public:
     /// if index -1, appends item, otherwise inserts before index
     long index = -1);
 
+  /// Returns true if the items of a virtual listview are filtered.
+  bool is_filtered() const { return m_filter != nullptr; }
+
+  /// Returns true if this is a virtual listview.
+  bool is_virtual() const { return HasFlag(wxLC_VIRTUAL); }
+
   /// Loads listview from list.
   bool load(const std::list<std::string>& l);
 
@@ -105,6 +139,9 @@ public:
   /// Returns false if an error occurred.
   bool set_item_image(long item_number, const wxArtID& artid);
 
+  /// Returns the store, containing the items of a virtual listview.
+  const auto& store() const { return m_store; }
+
   /// Sorts on a column specified by column name.
   /// Returns true if column was sorted.
   bool
@@ -144,8 +181,21 @@ protected:
   /// Builds the popup menu.
   virtual void build_popup_menu(menu& menu);
 
+  /// Other methods.
+
+  /// Watches a file (e.g. the file the items are loaded from),
+  /// the callback is invoked when the file is changed on disk.
+  void sync_watch(const path& p, std::function<void()> f);
+
+  /// Virtual methods from wxListCtrl, used for a virtual listview.
+
+  wxItemAttr* OnGetItemAttr(long item) const override;
+  int         OnGetItemImage(long item) const override;
+  wxString    OnGetItemText(long item, long column) const override;
+
 private:
   const std::string build_page();
+  const std::string cell_text(long item_number, int col) const;
   const std::string context(const std::string& line, int pos) const;
   void              copy_selection_to_clipboard();
   void              edit_delete();
@@ -158,13 +208,10 @@ private:
   void         item_activated(long item_number);
   bool         on_command(wxCommandEvent& event);
   void         process_match(wxCommandEvent& event);
-  bool         set_item_image(long item_number, int iconid)
-  {
-    return (
-      m_data.image() == data::listview::IMAGE_FILE_ICON ?
-        SetItemImage(item_number, iconid) :
-        false);
-  };
+  void         reorder(const std::vector<size_t>& order);
+  bool         set_item_image(long item_number, int iconid);
+  long         store_insert(const std::vector<std::string>& item, long index);
+  size_t       store_row(long item) const;
 
   const char m_field_separator = '\t';
 
@@ -172,15 +219,19 @@ private:
 
   data::listview m_data;
 
-  bool m_item_updated = false;
-  long m_item_number  = 0;
-
   int m_col_event_id     = -1;
   int m_sorted_column_no = -1, m_to_be_sorted_column_no = -1;
 
   std::map<wxArtID, unsigned int> m_art_ids;
   std::vector<column>             m_columns;
 
+  listview_store                   m_store;
+  std::vector<size_t>              m_view; // the store rows shown if filtered
+  std::unique_ptr<listview_filter> m_filter;
+  std::unique_ptr<listview_meta>   m_meta;
+  std::unique_ptr<listview_sync>   m_sync;
+  mutable wxItemAttr               m_attr, m_attr_readonly;
+
   frame* m_frame;
 
   static inline item_dialog* m_config_dialog = nullptr;
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      macro-command.h
+// Purpose:   Declaration of class wex::macro_command
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+namespace wex
+{
+/// Offers a compiled macro command.
+/// The parts of a recorded command that do not depend on
+/// the state of the component (like the address and command of
+/// an ex command) are parsed once, when the macro is compiled,
+/// so playing back the macro again does not parse them again.
+/// For a vi motion the count and the motion command are parsed once.
+/// Commands that cannot be compiled keep type TYPE_OTHER, and are parsed
+/// each time they are executed.
+class macro_command
+{
+public:
+  /// The command types.
+  enum type_t
+  {
+    TYPE_EX_ONE,    ///< ex command with one address (or none)
+    TYPE_EX_RANGE,  ///< ex command with an address range
+    TYPE_VI_MOTION, ///< vi motion, with count
+    TYPE_OTHER,     ///< other command
+  };
+
+  /// Constructor.
+  macro_command(
+    /// the command as recorded
+    const std::string& command,
+    /// the type
+    type_t type = TYPE_OTHER,
+    /// the (unevaluated) address or range
+    const std::string& range = std::string(),
+    /// the ex command
+    const std::string& cmd = std::string(),
+    /// the text following the ex command
+    const std::string& text = std::string())
+    : m_cmd(cmd)
+    , m_command(command)
+    , m_range(range)
+    , m_text(text)
+    , m_type(type)
+  {
+    ;
+  }
+
+  /// Constructor for a vi motion.
+  macro_command(
+    /// the command as recorded
+    const std::string& command,
+    /// the count
+    int count,
+    /// the index of the motion in the vi motion commands
+    size_t motion)
+    : m_command(command)
+    , m_count(count)
+    , m_motion(motion)
+    , m_type(TYPE_VI_MOTION)
+  {
+    ;
+  }
+
+  /// Returns the ex command.
+  const auto& cmd() const { return m_cmd; }
+
+  /// Returns the command as recorded.
+  const auto& command() const { return m_command; }
+
+  /// Returns the count of a vi motion.
+  auto count() const { return m_count; }
+
+  /// Returns the index of the vi motion.
+  auto motion() const { return m_motion; }
+
+  /// Returns the address or range.
+  const auto& range() const { return m_range; }
+
+  /// Returns the text following the ex command.
+  const auto& text() const { return m_text; }
+
+  /// Returns the type.
+  auto type() const { return m_type; }
+
+private:
+  std::string m_cmd, m_command, m_range, m_text;
+  int         m_count{1};
+  size_t      m_motion{0};
+  type_t      m_type;
+};
+}; // namespace wex
@@ -8,11 +8,13 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <pugixml.hpp>
 
+#include <wex/macro-command.h>
 #include <wex/macro-mode.h>
 #include <wex/variable.h>
 
@@ -21,6 +23,8 @@ namespace wex
 class ex;
 class path;
 class macro_fsm;
+class macros_writer;
+class register_file;
 
 /// Offers the macro collection, and allows
 /// recording and playback to vi (ex) component.
@@ -52,9 +56,20 @@ public:
   typedef std::map<std::string, std::vector<std::string>> macros_map_t;
   typedef std::map<std::string, variable>                 variables_map_t;
 
+  /// The commands of a compiled macro.
+  typedef std::shared_ptr<const std::vector<macro_command>> compiled_t;
+
   /// Default constructor.
   macros();
 
+  /// Destructor, saves changes not yet saved.
+  ~macros();
+
+  /// Copies register to another register, the backing file
+  /// of a large register is shared.
+  /// Returns false if register to copy from is empty.
+  bool copy_register(char from, char to);
+
   /// Erases current macro from the vector and cleans it.
   /// Returns true if macro was erased.
   bool erase();
@@ -78,12 +93,23 @@ public:
   const std::vector<std::string>
   get_macro_commands(const std::string& macro) const;
 
+  /// Returns compiled commands for specified macro.
+  /// The macro is compiled on first use, using the ex component,
+  /// and the compiled macro is kept until the macro is changed.
+  compiled_t get_macro_compiled(const std::string& macro, const ex* ex);
+
   /// Returns (string) map.
   const auto& get_map() const { return m_map; }
 
   /// Returns content of register.
+  /// For a large register this is a copy of its file,
+  /// use get_register_file to access it without copying.
   const std::string get_register(char name) const;
 
+  /// Returns the backing file of a large register,
+  /// or nullptr if the register is not large.
+  std::shared_ptr<register_file> get_register_file(char name) const;
+
   /// Returns all registers (with content) as a vector of strings.
   /// Does not include macros.
   const std::vector<std::string> get_registers() const;
@@ -93,7 +119,7 @@ public:
 
   /// Returns true if xml structure has been modified
   /// without being saved.
-  bool is_modified() const { return m_is_modified; }
+  bool is_modified() const;
 
   /// Is macro or variable recorded.
   bool is_recorded(const std::string& macro) const;
@@ -130,12 +156,16 @@ public:
     bool new_command = true);
 
   /// Saves all macros (and variables) to xml document.
-  /// If you specify only_if_modified, then document is only saved
-  /// if it was modified (if macros have been recorded since last save).
+  /// Normally changes are saved in the background, shortly after
+  /// the last change, and merged with the document on disk, so
+  /// changes made by other instances are kept.
+  /// If you specify only_if_modified, then the changes not yet saved
+  /// are saved now (if macros have been recorded since last save),
+  /// otherwise the complete document is saved.
   /// Returns true if document is saved.
   bool save_document(bool only_if_modified = true);
 
-  /// Saves macro (and calls save_document).
+  /// Saves macro (the document is saved in the background).
   void save_macro(const std::string& macro);
 
   /// Sets abbreviation (overwrites existing abbreviation).
@@ -152,6 +182,9 @@ public:
 
   /// Sets register (overwrites existing register).
   /// The name should be a one letter register.
+  /// If the value is larger than stc.max.Size register, it is
+  /// stored in a file in the config dir, and the document
+  /// only refers to that file.
   /// Returns false if name is not appropriate.
   bool set_register(char name, const std::string& value);
 
@@ -166,8 +199,10 @@ private:
   void
   parse_node(const pugi::xml_node& node, const std::string& name, T& container);
 
+  void journal(const std::string& element, const std::string& name);
   void parse_node_macro(const pugi::xml_node& node);
   void parse_node_variable(const pugi::xml_node& node);
+  void release_register_file(char name);
 
   template <typename S, typename T>
   void set(
@@ -176,7 +211,7 @@ private:
     const std::string& name,
     const std::string& value);
 
-  bool m_is_loaded{false}, m_is_modified{false};
+  bool m_is_loaded{false};
 
   pugi::xml_document m_doc;
 
@@ -185,10 +220,17 @@ private:
   /// Registers are 1 letter macros, and as such part of this container.
   macros_map_t m_macros;
 
+  std::map<std::string, compiled_t> m_compiled;
+
+  /// Large registers are not part of the macros container.
+  std::map<char, std::shared_ptr<register_file>> m_register_files;
+
   macro_mode m_mode;
 
   variables_map_t m_variables;
 
   keys_map_t m_map_alt_keys, m_map_control_keys, m_map_keys;
+
+  std::unique_ptr<macros_writer> m_writer;
 };
 }; // namespace wex
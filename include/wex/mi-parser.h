@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      mi-parser.h
+// Purpose:   Declaration of wex::mi_parser class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace wex
+{
+/// This class offers an incremental parser for the GDB/MI
+/// (machine interface) output of a debugger.
+/// Output is fed in chunks as it arrives, each complete record (line)
+/// is parsed once, and the records are converted into typed events.
+/// A record split over several chunks is parsed when its line is complete.
+class mi_parser
+{
+public:
+  /// An event produced by the parser.
+  struct event
+  {
+    /// The event types.
+    enum type_t
+    {
+      BREAKPOINT_CREATED, ///< a breakpoint was created
+      BREAKPOINT_DELETED, ///< a breakpoint was deleted
+      ERROR_MSG,          ///< an error result
+      EXITED,             ///< the program exited
+      PATH,               ///< symbols were read from a path
+      RUNNING,            ///< the program is running
+      STOPPED,            ///< the program stopped
+      VARIABLE,           ///< a variable value
+    };
+
+    /// The type.
+    type_t type;
+
+    /// The breakpoint number (BREAKPOINT_, STOPPED if at a breakpoint).
+    std::string no;
+
+    /// The file (BREAKPOINT_CREATED, STOPPED, PATH).
+    std::string file;
+
+    /// The line, as reported by the debugger, or 0 if not known.
+    int line{0};
+
+    /// Other text: message (ERROR_MSG), reason (STOPPED, EXITED),
+    /// value (VARIABLE).
+    std::string text;
+  };
+
+  /// The results of a record, a tuple member is accessed
+  /// using a dot (e.g. frame.line), a list element using its
+  /// index (e.g. stack.0.frame.line).
+  typedef std::map<std::string, std::string> results_t;
+
+  /// Feeds (part of) debugger output, and returns the events
+  /// for all records completed by this text.
+  std::vector<event> feed(const std::string& text);
+
+  /// Parses one record, sets its type char (e.g. *), class (e.g. stopped),
+  /// and fills results. For a stream record (~, @, &) the class
+  /// is the (unescaped) text.
+  /// Returns false if the line is not an MI record (e.g. the prompt).
+  static bool parse_record(
+    const std::string& line,
+    char&              type,
+    std::string&       record_class,
+    results_t&         results);
+
+  /// Clears pending output.
+  void reset();
+
+private:
+  void parse_line(const std::string& line, std::vector<event>& events);
+
+  std::string m_console, m_line;
+};
+}; // namespace wex
@@ -10,7 +10,9 @@
 #if wexUSE_ODBC
 
 #include <memory>
+#include <wex/data/csv.h>
 #include <wex/data/window.h>
+#include <wex/path.h>
 #include <wex/version.h>
 
 class wxGrid;
@@ -28,7 +30,8 @@ public:
   static const version_info get_version_info();
 
   /// Default constructor.
-  /// Initializes the eodbc connection using specified threaded mode.
+  /// Initializes the eodbc connection using specified threaded mode,
+  /// that is required by query_async.
   explicit odbc(bool threaded_mode = false, size_t buffer_size = 1024);
 
   /// Destructor.
@@ -67,6 +70,44 @@ public:
   /// Returns number of lines added.
   long query(const std::string& query, wxStyledTextCtrl* stc, bool& stopped);
 
+  /// Runs the query and writes results to the file, as specified
+  /// by the csv data, without keeping the rows.
+  /// The rows written per second are shown on the statusbar.
+  /// Returns number of rows written, or -1 in case there was an error.
+  long query(
+    const std::string& query,
+    const path&        p,
+    bool&              stopped,
+    const data::csv&   data = data::csv());
+
+  /// Runs the query on a worker thread, using its own connection,
+  /// and puts results on the grid while they are fetched.
+  /// The rows fetched are shown on the statusbar.
+  /// Returns false if not connected, not in threaded mode,
+  /// or a query is running.
+  bool query_async(
+    const std::string& query,
+    wxGrid*            grid,
+    bool               empty_results = true);
+
+  /// Runs the query on a worker thread, and appends results to the stc.
+  bool query_async(const std::string& query, wxStyledTextCtrl* stc);
+
+  /// Cancels the running query, the statement is cancelled
+  /// using SQLCancel once it is executed, a query that is still
+  /// logging on or executing stops as soon as that returns.
+  /// When the odbc is destroyed while such a query runs, it is not
+  /// waited for.
+  /// Returns false if no query is running.
+  bool query_cancel();
+
+  /// Returns true if a query is running.
+  bool query_running() const;
+
+  /// Returns number of rows fetched by the running or last query,
+  /// or -1 in case there was an error.
+  long query_rows() const;
+
 private:
   std::unique_ptr<odbc_imp> m_odbc;
 };
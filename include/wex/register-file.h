@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      register-file.h
+// Purpose:   Declaration of class wex::register_file
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <string>
+#include <string_view>
+#include <wex/path.h>
+
+namespace wex
+{
+/// Offers the contents of a large register, stored in a memory mapped
+/// file instead of in memory. The file is kept in the same dir as
+/// the macros document, as that document refers to it.
+/// The register is shared (using a shared_ptr) by all registers
+/// that refer to it. If it is released, the file is removed
+/// as soon as the last reference is gone, otherwise the file is kept.
+class register_file
+{
+public:
+  /// Constructor, writes text to a new file in specified dir.
+  register_file(const path& dir, const std::string& text);
+
+  /// Constructor, uses an existing file.
+  explicit register_file(const path& p);
+
+  /// Destructor, removes the file if released.
+  ~register_file();
+
+  /// Returns the contents.
+  const char* data() const
+  {
+    return static_cast<const char*>(m_region.get_address());
+  }
+
+  /// Returns true if the file is mapped.
+  bool is_ok() const { return m_is_ok; }
+
+  /// Returns the name of the file.
+  const auto& name() const { return m_name; }
+
+  /// Releases the file.
+  void release() { m_is_released = true; }
+
+  /// Returns the size.
+  size_t size() const { return m_is_ok ? m_region.get_size() : 0; }
+
+  /// Returns the contents as a string.
+  const std::string text() const { return std::string(data(), size()); }
+
+  /// Returns the contents as a view on the mapped file.
+  std::string_view view() const { return std::string_view(data(), size()); }
+
+private:
+  void map();
+
+  static inline int m_no{0};
+
+  const std::string m_name;
+
+  boost::interprocess::file_mapping  m_mapping;
+  boost::interprocess::mapped_region m_region;
+
+  bool m_is_ok{false}, m_is_released{false};
+};
+}; // namespace wex
@@ -10,6 +10,7 @@
 #include <list>
 #include <vector>
 #include <wex/stc.h>
+#include <wx/timer.h>
 
 namespace wex
 {
@@ -49,9 +50,13 @@ public:
 
   /// Virtual interface
 
-  /// Appends text, and updates the command start position.
+  /// Appends text (and output still pending), and updates the
+  /// command start position.
   /// Only if the cursor was at the end, the cursor is
-  /// repositioned at the end after appending the text,
+  /// repositioned at the end after appending the text, and
+  /// the text is scrolled into view, unless you scrolled up.
+  /// If the number of lines exceeds the stc.max.Shell lines config value,
+  /// the oldest lines are removed.
   void AppendText(const wxString& text) override;
 
   // Paste the contents of the clipboard into the document replacing the
@@ -100,6 +105,7 @@ public:
   bool set_prompt(const std::string& prompt, bool do_prompt = true);
 
 private:
+  void append_pending(const wxString& text);
   void expand();
   void keep_command();
   void process_char_default(int key);
@@ -109,6 +115,7 @@ private:
   bool set_command_from_history(const std::string& short_command);
   void show_command(int key);
   void show_history();
+  void trim(bool scrolled_up);
 
   const std::string m_command_end;
   const bool        m_echo;
@@ -123,6 +130,9 @@ private:
 
   std::string m_command, m_prompt;
 
+  wxString m_append;
+  wxTimer  m_append_timer;
+
   int m_command_start_pos =
     0; /// position after the prompt from where commands can be inserted
   bool m_enabled = true;
@@ -10,6 +10,7 @@
 #include <bitset>
 #include <vector>
 #include <wex/data/stc.h>
+#include <wex/factory/filter.h>
 #include <wex/factory/stc.h>
 #include <wex/hexmode.h>
 #include <wex/item.h>
@@ -107,6 +108,11 @@ public:
   /// Returns the file.
   auto& get_file() { return m_file; }
 
+  /// Returns the filter, used to pipe the text to a process
+  /// (e.g. a beautifier). A running filter is cancelled when
+  /// this component is destroyed.
+  auto& get_filter() { return m_filter; }
+
   /// Returns frame.
   auto get_frame() { return m_frame; }
 
@@ -116,6 +122,10 @@ public:
   /// Returns writable hex mode component.
   auto& get_hexmode() { return m_hexmode; }
 
+  /// Returns the number of text insertions and deletions,
+  /// to find out whether the text was changed meanwhile.
+  auto get_modifications() const { return m_modifications; }
+
   /// Returns vi component.
   const vi& get_vi() const;
 
@@ -298,13 +308,16 @@ private:
 
   bool m_skip{false};
 
+  size_t m_modifications{0};
+
   frame* m_frame;
 
   class auto_complete* m_auto_complete;
   hexmode              m_hexmode;
 
-  data::stc m_data;
-  stc_file  m_file;
+  data::stc       m_data;
+  factory::filter m_filter;
+  stc_file        m_file;
 
   // The ex or vi component.
   vi* m_vi{nullptr};
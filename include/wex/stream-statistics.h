@@ -7,76 +7,113 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <wex/statistics.h>
 #include <wx/translation.h>
 
 namespace wex
 {
 /// Offers stream_statistics.
-/// Used by stream to keep statistics.
+/// Used by stream and dir to keep statistics, that can be incremented
+/// from several threads without locking. The keys are interned,
+/// each thread increments its own atomic counters, and the counters
+/// of all threads are merged when read, using get.
 class stream_statistics
 {
 public:
+  /// Returns the id of the key, the key is interned if not yet present.
+  static size_t key_id(const std::string& key);
+
+  /// Default constructor.
+  stream_statistics() = default;
+
+  /// Copy constructor.
+  stream_statistics(const stream_statistics& s) { *this += s; }
+
+  /// Destructor.
+  ~stream_statistics();
+
+  /// Assignment operator.
+  stream_statistics& operator=(const stream_statistics& s);
+
   /// Adds other statistics.
-  stream_statistics& operator+=(const stream_statistics& s)
-  {
-    m_elements += s.m_elements;
-    return *this;
-  }
+  stream_statistics& operator+=(const stream_statistics& s);
 
   /// Clears the statistics.
-  void clear() { m_elements.clear(); }
+  void clear();
 
   /// Returns true if statistics are empty.
-  bool empty() const { return m_elements.empty(); }
+  bool empty() const;
 
   /// Returns all items as a string. All items are returned as a string,
   /// with newlines separating items.
-  const std::string get() const { return m_elements.get(); }
+  const std::string get() const { return get_elements().get(); }
 
-  /// Returns the key, if not present 0 is returned.
+  /// Returns the key, as merged from all threads,
+  /// if not present 0 is returned, and the key is not interned.
   int get(const std::string& key) const;
 
-  /// Returns the elements.
-  const auto& get_elements() const { return m_elements; }
+  /// Returns actions completed, as merged from all threads.
+  int get_actions_completed() const;
 
-  /// Returns the elements.
-  auto& get_elements() { return m_elements; }
+  /// Returns the elements, as merged from all threads.
+  statistics<int> get_elements() const;
 
   /// Increments keyword.
-  int inc(const std::string& keyword, int inc_value = 1);
+  /// Returns the value of the calling thread only, not merged,
+  /// as are the other inc methods.
+  int inc(const std::string& keyword, int inc_value = 1)
+  {
+    return add(key_id(keyword), inc_value);
+  }
 
   /// Increments actions.
   int inc_actions();
 
-  /// Increments actions comleted.
+  /// Increments actions completed.
   int inc_actions_completed(int inc_value = 1);
 
+  /// Sets key to value, and returns the merged value.
+  int set(const std::string& key, int value);
+
 private:
-  statistics<int> m_elements;
+  struct counter
+  {
+    std::atomic<int>  value{0};
+    std::atomic<bool> used{false};
+  };
+
+  // The counters of a shard are allocated in blocks,
+  // when a key in the block is used for the first time.
+  typedef std::array<counter, 32>             block;
+  typedef std::array<std::atomic<block*>, 32> shard;
+  typedef std::array<std::atomic<shard*>, 16> shards;
+
+  int      add(size_t id, int value);
+  counter* find(const shard* s, size_t id) const;
+  int      get(size_t id) const;
+
+  shards m_shards{};
 };
 
 // implementation
 
-inline int wex::stream_statistics::get(const std::string& key) const
-{
-  const auto it = m_elements.get_items().find(key);
-  return (it != m_elements.get_items().end() ? it->second : 0);
-}
-
-inline int
-wex::stream_statistics::inc(const std::string& keyword, int inc_value)
+inline int wex::stream_statistics::inc_actions()
 {
-  return m_elements.inc(keyword, inc_value);
+  static const auto id(key_id(_("Files").ToStdString()));
+  return add(id, 1);
 }
 
-inline int wex::stream_statistics::inc_actions()
+inline int wex::stream_statistics::get_actions_completed() const
 {
-  return inc(_("Files").ToStdString());
+  static const auto id(key_id(_("Actions Completed").ToStdString()));
+  return get(id);
 }
 
 inline int wex::stream_statistics::inc_actions_completed(int inc_value)
 {
-  return inc(_("Actions Completed").ToStdString(), inc_value);
+  static const auto id(key_id(_("Actions Completed").ToStdString()));
+  return add(id, inc_value);
 }
 }; // namespace wex
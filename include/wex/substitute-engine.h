@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      substitute-engine.h
+// Purpose:   Declaration of wex::substitute_engine class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <bitset>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace wex
+{
+  namespace factory
+  {
+    class stc;
+  };
+
+  /// Offers a single pass substitute engine.
+  /// The text is read once, the pattern is compiled once,
+  /// and the replaced text is built in one pass, so there is
+  /// no repeated search and replace of the target on the component.
+  /// Matching is done line by line (as scintilla does),
+  /// so ^ and $ match at line boundaries.
+  class substitute_engine
+  {
+  public:
+    enum
+    {
+      SUBSTITUTE_GLOBAL     = 0, ///< replace all matches on a line
+      SUBSTITUTE_MATCH_CASE = 1, ///< match case
+      SUBSTITUTE_MATCH_WORD = 2, ///< match whole word (not for regex)
+      SUBSTITUTE_REGEX      = 3, ///< pattern is a regular expression
+      SUBSTITUTE_VI         = 4, ///< replacement uses vi syntax
+    };
+
+    typedef std::bitset<5> substitute_t;
+
+    /// Positions to be mapped from input to output text.
+    typedef std::vector<int> positions_t;
+
+    /// Constructor.
+    substitute_engine(
+      /// the pattern to search for
+      const std::string& pattern,
+      /// the replacement text, depending on flags:
+      /// - SUBSTITUTE_VI: & or \\0 is target, \\1 .. \\9 submatch,
+      ///   \\U and \\L convert case of target, if SUBSTITUTE_REGEX
+      ///   is set as well, the result is next used as a regex replacement
+      /// - SUBSTITUTE_REGEX: \\0 .. \\9 submatch, and escaped chars
+      ///   (as scintilla ReplaceTargetRE)
+      /// - otherwise replacement is used literally
+      const std::string& replacement,
+      /// flags
+      substitute_t flags = substitute_t().set(SUBSTITUTE_GLOBAL));
+
+    /// Returns true if pattern is valid.
+    bool is_ok() const { return m_is_ok; }
+
+    /// Substitutes range on the component, inside one undo action.
+    /// The caret and anchor are kept as if each match was replaced
+    /// separately.
+    /// Returns number of replacements, or -1 if an error occurred.
+    int range(factory::stc* stc, int start, int end);
+
+    /// Substitutes input text, and stores result in output.
+    /// Returns number of replacements.
+    int string(
+      /// text to substitute
+      const std::string& input,
+      /// the substituted text
+      std::string& output,
+      /// optional positions in input, mapped to positions in output
+      positions_t* positions = nullptr);
+
+  private:
+    struct edit_t
+    {
+      size_t in_begin, in_end, out_begin, out_end;
+    };
+
+    void add_regex(
+      std::string&       output,
+      const std::smatch* m,
+      const std::string& replacement) const;
+    void add_replacement(
+      std::string&       output,
+      const std::smatch* m,
+      const std::string& target) const;
+    bool find_literal(
+      const std::string& input,
+      size_t             from,
+      size_t             to,
+      size_t&            pos) const;
+    bool is_word_char(char c) const;
+
+    const substitute_t m_flags;
+    const std::string  m_pattern, m_replacement;
+
+    std::unique_ptr<std::regex> m_regex;
+    std::vector<edit_t>         m_edits;
+
+    bool m_is_ok{true};
+  };
+} // namespace wex
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      text-diff.h
+// Purpose:   Declaration of wex::text_diff
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace wex
+{
+/// A part of the text that is replaced by a part of the other text,
+/// both as a [begin, end) range of byte positions.
+struct text_hunk
+{
+  /// The begin in the text.
+  size_t begin;
+
+  /// The end in the text.
+  size_t end;
+
+  /// The begin in the other text.
+  size_t other_begin;
+
+  /// The end in the other text.
+  size_t other_end;
+};
+
+/// Returns the hunks, in order of position, that change the text into
+/// the other text, comparing lines (Myers diff). If the texts differ in
+/// more than max lines, one hunk is returned, covering all lines
+/// between the common leading and trailing lines.
+std::vector<text_hunk> text_diff(
+  const std::string_view& text,
+  const std::string_view& other,
+  size_t                  max = 1000);
+}; // namespace wex
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      vcs-batch.h
+// Purpose:   Declaration of wex::vcs_batch class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <wex/path.h>
+#include <wex/vcs-entry.h>
+
+namespace wex
+{
+/// Offers batch execution of the current command of a vcs entry
+/// for several files, the processes are run by the executor.
+/// - A command that behaves like opening a file (blame, log, diff etc.)
+///   is run for each file separately, with at most max_parallel
+///   processes running at the same time.
+/// - Other commands get all files as arguments, split over
+///   several processes that run one after another, if the arguments
+///   would exceed the max command size.
+///
+/// Progress is shown on the statusbar, and a running batch is cancelled
+/// using interruptible::cancel.
+class vcs_batch
+{
+public:
+  /// A process to run.
+  struct job
+  {
+    /// The files used as arguments.
+    std::vector<path> files;
+
+    /// The command line.
+    std::string exe;
+
+    /// The working directory.
+    std::string wd;
+  };
+
+  /// Callback for each finished process, invoked from the main thread.
+  /// The entry contains the exe, stdout and stderr of the process.
+  typedef std::function<
+    void(const std::vector<path>& files, const vcs_entry& entry)>
+    callback_t;
+
+  /// Callback when the batch is finished or cancelled, invoked
+  /// from the main thread. The entry stdout contains the combined output,
+  /// followed by the status of each file that failed or was cancelled,
+  /// and stderr contains these statuses only.
+  typedef std::function<void(const vcs_entry& entry)> done_t;
+
+  /// Static interface.
+
+  /// Returns the max size of a command line.
+  static size_t max_command_size();
+
+  /// Returns the max number of processes of a batch running at the
+  /// same time, one less than the max children of the executor,
+  /// so a batch does not hold up other async processes.
+  static size_t max_parallel();
+
+  /// Other methods.
+
+  /// Constructor, builds the jobs for the current command of the entry.
+  vcs_batch(
+    /// the vcs entry
+    const vcs_entry& entry,
+    /// the files
+    const std::vector<path>& files,
+    /// max size of a command line, 0 uses max_command_size
+    size_t max_size = 0);
+
+  /// Starts the batch, and returns immediately.
+  /// Returns false if there are no jobs, or another
+  /// interruptible process is running.
+  bool execute(callback_t f, done_t done = nullptr) const;
+
+  /// Returns true if the jobs can run in parallel.
+  bool is_parallel() const { return m_parallel; }
+
+  /// Returns the jobs.
+  const auto& jobs() const { return m_jobs; }
+
+private:
+  const vcs_entry  m_entry;
+  std::vector<job> m_jobs;
+  bool             m_parallel{false};
+};
+}; // namespace wex
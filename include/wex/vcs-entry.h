@@ -23,6 +23,8 @@ class vcs_entry
   : public process
   , public menu_commands<vcs_command>
 {
+  friend class vcs_batch_state;
+
 public:
   enum
   {
@@ -44,6 +46,12 @@ public:
     /// menu to be built
     menu* menu) const;
 
+  /// Returns the command line for the current vcs command,
+  /// as used by execute.
+  const std::string command_line(
+    /// args, like filenames, or vcs flags
+    const std::string& args = std::string()) const;
+
   /// Executes the current vcs command (from SetCommand), or
   /// the first command if SetCommand was not yet invoked.
   /// Might ask for vcs binary if it is not yet known.
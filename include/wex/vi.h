@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <string>
 #include <vector>
@@ -33,6 +34,13 @@ public:
   /// Returns true if the command was executed.
   bool command(const std::string& command) final;
 
+  /// Executes compiled macro command.
+  /// Returns true if the command was executed.
+  bool command(const macro_command& command) final;
+
+  /// Compiles a command for macro playback, adds vi motions.
+  const macro_command compile(const std::string& command) const final;
+
   /// Returns inserted text.
   const auto& inserted_text() const { return m_insert_text; }
 
@@ -75,6 +83,10 @@ private:
     std::function<size_t(const std::string& command)>>>
     commands_t;
 
+  /// jump table, for each first char of a command the indices of the
+  /// commands that might handle it, in order of the commands
+  typedef std::array<std::vector<size_t>, 256> commands_index_t;
+
   enum class motion_t;
 
   void     command_reg(const std::string& reg);
@@ -103,6 +115,8 @@ private:
 
   const commands_t m_motion_commands, m_other_commands;
 
+  const commands_index_t m_motion_index, m_other_index;
+
   const std::vector<std::string> m_last_commands;
 };
 }; // namespace wex
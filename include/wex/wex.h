@@ -50,6 +50,7 @@
 #include <wex/link.h>
 #include <wex/listitem.h>
 #include <wex/log.h>
+#include <wex/macro-command.h>
 #include <wex/macro-mode.h>
 #include <wex/macros.h>
 #include <wex/marker.h>
@@ -59,6 +60,7 @@
 #include <wex/menu.h>
 #include <wex/menubar.h>
 #include <wex/menus.h>
+#include <wex/mi-parser.h>
 #include <wex/notebook.h>
 #include <wex/odbc.h>
 #include <wex/open-files-dialog.h>
@@ -83,6 +85,7 @@
 #include <wex/stream-statistics.h>
 #include <wex/stream.h>
 #include <wex/style.h>
+#include <wex/substitute-engine.h>
 #include <wex/temp-filename.h>
 #include <wex/textctrl-input.h>
 #include <wex/textctrl.h>
@@ -94,6 +97,7 @@
 #include <wex/type-to-value.h>
 #include <wex/util.h>
 #include <wex/variable.h>
+#include <wex/vcs-batch.h>
 #include <wex/vcs-command.h>
 #include <wex/vcs-entry.h>
 #include <wex/vcs.h>
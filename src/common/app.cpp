@@ -5,6 +5,7 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <csignal>
 #include <filesystem>
 
 #include <wx/clipbrd.h>
@@ -15,6 +16,7 @@
 #include <wex/app.h>
 #include <wex/config.h>
 #include <wex/core.h>
+#include <wex/factory/executor.h>
 #include <wex/lexers.h>
 #include <wex/log.h>
 #include <wex/printing.h>
@@ -25,6 +27,7 @@ namespace fs = std::filesystem;
 
 int wex::app::OnExit()
 {
+  delete factory::executor::set(nullptr);
   delete lexers::set(nullptr);
   delete printing::set(nullptr);
 
@@ -50,6 +53,12 @@ bool wex::app::OnInit()
 
   config::on_init();
 
+#ifndef __WXMSW__
+  // A process that does not read all the input piped to it (e.g. ls)
+  // should not terminate us, a failing write is handled instead.
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
+
   const wxLanguageInfo* info = nullptr;
 
   if (const auto& lang(config("Language").get()); !lang.empty())
@@ -13,6 +13,7 @@ wex::debug_entry::debug_entry(const pugi::xml_node& node)
   , m_break_del(node.attribute("break-del").value())
   , m_break_set(node.attribute("break-set").value())
   , m_extensions(node.attribute("extensions").value())
+  , m_is_mi(node.attribute("mi").as_bool())
   , m_regex_stdouts(
       {{regex_t::AT_LINE, node.attribute("regex-at-line").value()},
        {regex_t::AT_PATH_LINE, node.attribute("regex-at-path-line").value()},
@@ -152,7 +152,9 @@ bool wex::dir::find_files(const tool& tool)
 
 void wex::dir::find_files_end() const
 {
-  log::status(m_tool.info(&m_statistics.get_elements()));
+  const auto stats(m_statistics.get_elements());
+
+  log::status(m_tool.info(&stats));
 
   if (m_eh != nullptr)
   {
@@ -163,7 +165,7 @@ void wex::dir::find_files_end() const
 
 int wex::dir::matches() const
 {
-  return m_statistics.get_elements().get(_("Files"));
+  return m_statistics.get(_("Files").ToStdString());
 }
 
 bool wex::dir::on_dir(const path& p) const
@@ -172,7 +174,7 @@ bool wex::dir::on_dir(const path& p) const
   {
     if (!m_tool.is_find_type() && m_data.type().test(data::dir::DIRS))
     {
-      m_statistics.get_elements().inc(_("Folders"));
+      m_statistics.inc(_("Folders").ToStdString());
       post_event(p);
     }
   }
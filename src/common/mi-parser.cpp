@@ -0,0 +1,370 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      mi-parser.cpp
+// Purpose:   Implementation of wex::mi_parser class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <wex/mi-parser.h>
+
+namespace wex
+{
+namespace
+{
+bool parse_value(
+  const std::string&    s,
+  size_t&               i,
+  const std::string&    name,
+  mi_parser::results_t& results);
+
+bool parse_cstring(const std::string& s, size_t& i, std::string& out)
+{
+  // s[i] is the opening quote
+  for (i++; i < s.size(); i++)
+  {
+    if (s[i] == '"')
+    {
+      i++;
+      return true;
+    }
+    else if (s[i] != '\\' || i + 1 == s.size())
+    {
+      out += s[i];
+      continue;
+    }
+
+    switch (const auto c = s[++i]; c)
+    {
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+
+      case '0':
+      case '1':
+      case '2':
+      case '3':
+      case '4':
+      case '5':
+      case '6':
+      case '7':
+      {
+        int oct = 0;
+        for (int n = 0; n < 3 && i < s.size() && s[i] >= '0' && s[i] <= '7';
+             n++)
+        {
+          oct = oct * 8 + (s[i++] - '0');
+        }
+        out += static_cast<char>(oct);
+        i--;
+      }
+      break;
+
+      default:
+        out += c;
+    }
+  }
+
+  return false;
+}
+
+// Parses name=value.
+bool parse_result(
+  const std::string&    s,
+  size_t&               i,
+  const std::string&    prefix,
+  mi_parser::results_t& results)
+{
+  const auto eq = s.find('=', i);
+
+  if (eq == std::string::npos)
+  {
+    return false;
+  }
+
+  const auto name(prefix + s.substr(i, eq - i));
+  i = eq + 1;
+
+  return parse_value(s, i, name, results);
+}
+
+bool parse_value(
+  const std::string&    s,
+  size_t&               i,
+  const std::string&    name,
+  mi_parser::results_t& results)
+{
+  if (i >= s.size())
+  {
+    return false;
+  }
+
+  switch (s[i])
+  {
+    case '"':
+    {
+      std::string value;
+      if (!parse_cstring(s, i, value))
+      {
+        return false;
+      }
+      // the first value is kept
+      results.emplace(name, value);
+      return true;
+    }
+
+    case '{':
+    case '[':
+    {
+      const auto end   = (s[i] == '{' ? '}' : ']');
+      const bool tuple = (s[i] == '{');
+
+      for (int n = 0; ++i < s.size(); n++)
+      {
+        if (s[i] == end)
+        {
+          i++;
+          return true;
+        }
+
+        const auto prefix(
+          name + "." + (tuple ? std::string() : std::to_string(n) + "."));
+
+        if (!tuple && (s[i] == '"' || s[i] == '{' || s[i] == '['))
+        {
+          if (!parse_value(s, i, name + "." + std::to_string(n), results))
+          {
+            return false;
+          }
+        }
+        else if (!parse_result(s, i, prefix, results))
+        {
+          return false;
+        }
+
+        if (i < s.size() && s[i] == end)
+        {
+          i++;
+          return true;
+        }
+        else if (i >= s.size() || s[i] != ',')
+        {
+          return false;
+        }
+      }
+
+      return false;
+    }
+
+    default:
+      return false;
+  }
+}
+
+int to_line(const std::string& text)
+{
+  return std::atoi(text.c_str());
+}
+}; // namespace
+}; // namespace wex
+
+std::vector<wex::mi_parser::event> wex::mi_parser::feed(const std::string& text)
+{
+  std::vector<event> events;
+  size_t             start = 0;
+
+  for (size_t pos; (pos = text.find('\n', start)) != std::string::npos;
+       start = pos + 1)
+  {
+    if (m_line.empty())
+    {
+      parse_line(text.substr(start, pos - start), events);
+    }
+    else
+    {
+      m_line.append(text, start, pos - start);
+      parse_line(m_line, events);
+      m_line.clear();
+    }
+  }
+
+  m_line.append(text, start, std::string::npos);
+
+  return events;
+}
+
+void wex::mi_parser::parse_line(
+  const std::string&  line_org,
+  std::vector<event>& events)
+{
+  const auto line(
+    !line_org.empty() && line_org.back() == '\r' ?
+      line_org.substr(0, line_org.size() - 1) :
+      line_org);
+
+  char        type;
+  std::string record_class;
+  results_t   r;
+
+  if (!parse_record(line, type, record_class, r))
+  {
+    return;
+  }
+
+  const auto get = [&r](const std::string& key)
+  {
+    const auto& it = r.find(key);
+    return it != r.end() ? it->second : std::string();
+  };
+
+  const auto get_file = [&get](const std::string& prefix)
+  {
+    const auto& full(get(prefix + ".fullname"));
+    return !full.empty() ? full : get(prefix + ".file");
+  };
+
+  switch (type)
+  {
+    case '~':
+      if (const std::string symbols("Reading symbols from ");
+          record_class.starts_with(symbols))
+      {
+        const auto end = record_class.find("...");
+        events.push_back(
+          {event::PATH,
+           std::string(),
+           record_class.substr(
+             symbols.size(),
+             end != std::string::npos ? end - symbols.size() :
+                                        std::string::npos)});
+      }
+      m_console += record_class;
+      break;
+
+    case '^':
+      // a value printed using the console, like $1 = 5
+      if (const auto eq = m_console.find(" = ");
+          m_console.starts_with("$") && eq != std::string::npos &&
+          m_console.find_first_not_of("0123456789", 1) == eq)
+      {
+        auto value(m_console.substr(eq + 3));
+        while (!value.empty() && value.back() == '\n')
+        {
+          value.pop_back();
+        }
+        events.push_back({event::VARIABLE, {}, {}, 0, value});
+      }
+
+      m_console.clear();
+
+      if (record_class == "error")
+      {
+        events.push_back({event::ERROR_MSG, {}, {}, 0, get("msg")});
+      }
+      else if (record_class == "done")
+      {
+        if (r.contains("bkpt.number"))
+        {
+          events.push_back(
+            {event::BREAKPOINT_CREATED,
+             get("bkpt.number"),
+             get_file("bkpt"),
+             to_line(get("bkpt.line"))});
+        }
+        else if (r.contains("value"))
+        {
+          events.push_back({event::VARIABLE, {}, {}, 0, get("value")});
+        }
+      }
+      break;
+
+    case '*':
+      if (record_class == "running")
+      {
+        events.push_back({event::RUNNING});
+      }
+      else if (record_class == "stopped")
+      {
+        if (const auto& reason(get("reason")); reason.starts_with("exited"))
+        {
+          events.push_back({event::EXITED, {}, {}, 0, reason});
+        }
+        else
+        {
+          events.push_back(
+            {event::STOPPED,
+             get("bkptno"),
+             get_file("frame"),
+             to_line(get("frame.line")),
+             reason});
+        }
+      }
+      break;
+
+    case '=':
+      if (record_class == "breakpoint-created")
+      {
+        events.push_back(
+          {event::BREAKPOINT_CREATED,
+           get("bkpt.number"),
+           get_file("bkpt"),
+           to_line(get("bkpt.line"))});
+      }
+      else if (record_class == "breakpoint-deleted")
+      {
+        events.push_back({event::BREAKPOINT_DELETED, get("id")});
+      }
+      break;
+  }
+}
+
+bool wex::mi_parser::parse_record(
+  const std::string& line,
+  char&              type,
+  std::string&       record_class,
+  results_t&         results)
+{
+  // skip the optional token
+  auto i = line.find_first_not_of("0123456789");
+
+  if (
+    i == std::string::npos ||
+    std::string("^*+=~@&").find(line[i]) == std::string::npos)
+  {
+    return false;
+  }
+
+  type = line[i++];
+  record_class.clear();
+
+  if (type == '~' || type == '@' || type == '&')
+  {
+    return i < line.size() && line[i] == '"' &&
+           parse_cstring(line, i, record_class);
+  }
+
+  const auto comma = line.find(',', i);
+  record_class     = line.substr(i, comma - i);
+
+  for (i = comma; i != std::string::npos && i < line.size();)
+  {
+    if (line[i] != ',' || !parse_result(line, ++i, std::string(), results))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void wex::mi_parser::reset()
+{
+  m_console.clear();
+  m_line.clear();
+}
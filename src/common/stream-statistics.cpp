@@ -0,0 +1,288 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      stream-statistics.cpp
+// Purpose:   Implementation of wex::stream_statistics class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include <wex/log.h>
+#include <wex/stream-statistics.h>
+
+namespace wex
+{
+// The interned keys, shared by all stream statistics.
+class stream_keys
+{
+public:
+  static stream_keys& get()
+  {
+    static stream_keys keys;
+    return keys;
+  }
+
+  // Returns the id of the key, or npos if the key is not interned.
+  size_t find(const std::string& key) const
+  {
+    std::shared_lock lock(m_mutex);
+
+    const auto& it = m_ids.find(key);
+
+    return it != m_ids.end() ? it->second : std::string::npos;
+  }
+
+  size_t id(const std::string& key)
+  {
+    {
+      std::shared_lock lock(m_mutex);
+
+      if (const auto& it = m_ids.find(key); it != m_ids.end())
+      {
+        return it->second;
+      }
+    }
+
+    std::unique_lock lock(m_mutex);
+
+    const auto& it = m_ids.try_emplace(key, m_names.size());
+
+    if (it.second)
+    {
+      m_names.emplace_back(key);
+    }
+
+    return it.first->second;
+  }
+
+  const std::string name(size_t id) const
+  {
+    std::shared_lock lock(m_mutex);
+    return m_names[id];
+  }
+
+  size_t size() const
+  {
+    std::shared_lock lock(m_mutex);
+    return m_names.size();
+  }
+
+private:
+  mutable std::shared_mutex               m_mutex;
+  std::unordered_map<std::string, size_t> m_ids;
+  std::vector<std::string>                m_names;
+};
+
+// Returns the element, allocated by the first thread using it.
+template <typename T> T* allocate(std::atomic<T*>& p)
+{
+  auto* t = p.load(std::memory_order_acquire);
+
+  if (t == nullptr)
+  {
+    auto* n = new T{};
+
+    if (p.compare_exchange_strong(t, n, std::memory_order_acq_rel))
+    {
+      t = n;
+    }
+    else
+    {
+      delete n;
+    }
+  }
+
+  return t;
+}
+
+// Returns the shard for the calling thread, threads get
+// a shard in order of first use.
+size_t shard_no(size_t shards)
+{
+  static std::atomic<size_t> next{0};
+  thread_local const size_t  no = next++;
+  return no % shards;
+}
+}; // namespace wex
+
+wex::stream_statistics::~stream_statistics()
+{
+  for (auto& s : m_shards)
+  {
+    if (auto* shard = s.load(); shard != nullptr)
+    {
+      for (auto& b : *shard)
+      {
+        delete b.load();
+      }
+
+      delete shard;
+    }
+  }
+}
+
+wex::stream_statistics&
+wex::stream_statistics::operator=(const stream_statistics& s)
+{
+  if (this != &s)
+  {
+    clear();
+    *this += s;
+  }
+
+  return *this;
+}
+
+wex::stream_statistics&
+wex::stream_statistics::operator+=(const stream_statistics& s)
+{
+  const auto elements(s.get_elements());
+
+  for (const auto& it : elements.get_items())
+  {
+    add(key_id(it.first), it.second);
+  }
+
+  return *this;
+}
+
+int wex::stream_statistics::add(size_t id, int value)
+{
+  const auto block_size = std::tuple_size<block>::value;
+
+  if (id >= std::tuple_size<shard>::value * block_size)
+  {
+    log("stream statistics too many keys") << id;
+    return 0;
+  }
+
+  auto* s = allocate(m_shards[shard_no(m_shards.size())]);
+  auto* b = allocate((*s)[id / block_size]);
+  auto& c = (*b)[id % block_size];
+
+  c.used.store(true, std::memory_order_relaxed);
+
+  // Only the counter of this shard, merging all shards is left to get.
+  return c.value.fetch_add(value, std::memory_order_relaxed) + value;
+}
+
+void wex::stream_statistics::clear()
+{
+  for (auto& s : m_shards)
+  {
+    if (auto* shard = s.load(std::memory_order_acquire); shard != nullptr)
+    {
+      for (auto& b : *shard)
+      {
+        if (auto* block = b.load(std::memory_order_acquire); block != nullptr)
+        {
+          for (auto& c : *block)
+          {
+            c.value.store(0, std::memory_order_relaxed);
+            c.used.store(false, std::memory_order_relaxed);
+          }
+        }
+      }
+    }
+  }
+}
+
+bool wex::stream_statistics::empty() const
+{
+  for (size_t id = 0; id < stream_keys::get().size(); id++)
+  {
+    if (std::any_of(
+          m_shards.begin(),
+          m_shards.end(),
+          [this, id](const auto& s)
+          {
+            const auto* c = find(s.load(std::memory_order_acquire), id);
+            return c != nullptr && c->used.load(std::memory_order_relaxed);
+          }))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+wex::stream_statistics::counter*
+wex::stream_statistics::find(const shard* s, size_t id) const
+{
+  const auto block_size = std::tuple_size<block>::value;
+
+  if (s == nullptr || id >= std::tuple_size<shard>::value * block_size)
+  {
+    return nullptr;
+  }
+
+  auto* b = (*s)[id / block_size].load(std::memory_order_acquire);
+
+  return b != nullptr ? &(*b)[id % block_size] : nullptr;
+}
+
+int wex::stream_statistics::get(size_t id) const
+{
+  int value = 0;
+
+  for (const auto& s : m_shards)
+  {
+    if (const auto* c = find(s.load(std::memory_order_acquire), id);
+        c != nullptr)
+    {
+      value += c->value.load(std::memory_order_relaxed);
+    }
+  }
+
+  return value;
+}
+
+int wex::stream_statistics::get(const std::string& key) const
+{
+  const auto id(stream_keys::get().find(key));
+  return id != std::string::npos ? get(id) : 0;
+}
+
+wex::statistics<int> wex::stream_statistics::get_elements() const
+{
+  statistics<int> elements;
+
+  for (size_t id = 0; id < stream_keys::get().size(); id++)
+  {
+    bool used  = false;
+    int  value = 0;
+
+    for (const auto& s : m_shards)
+    {
+      if (const auto* c = find(s.load(std::memory_order_acquire), id);
+          c != nullptr && c->used.load(std::memory_order_relaxed))
+      {
+        used = true;
+        value += c->value.load(std::memory_order_relaxed);
+      }
+    }
+
+    if (used)
+    {
+      elements.set(stream_keys::get().name(id), value);
+    }
+  }
+
+  return elements;
+}
+
+size_t wex::stream_statistics::key_id(const std::string& key)
+{
+  return stream_keys::get().id(key);
+}
+
+int wex::stream_statistics::set(const std::string& key, int value)
+{
+  const auto id(key_id(key));
+  add(id, value - get(id));
+  return get(id);
+}
@@ -110,9 +110,11 @@ bool wex::stream::process(std::string& text, size_t line_no)
       process_match(path_match(path(), text, line_no, pos));
     }
 
-    const auto ac = m_stats.inc_actions_completed(count);
+    m_stats.inc_actions_completed(count);
 
-    if (!m_asked && m_threshold != -1 && (ac - m_prev > m_threshold))
+    if (
+      !m_asked && m_threshold != -1 &&
+      m_stats.get_actions_completed() - m_prev > m_threshold)
     {
       if (
         wxMessageBox(
@@ -144,7 +146,7 @@ bool wex::stream::process_begin()
     return false;
   }
 
-  m_prev  = m_stats.get(_("Actions Completed").ToStdString());
+  m_prev  = m_stats.get_actions_completed();
   m_write = (m_tool.id() == ID_TOOL_REPLACE);
 
   if (!m_frd->is_regex())
@@ -206,7 +208,7 @@ bool wex::stream::run_tool()
   {
     m_asked = false;
 
-    m_stats.get_elements().set(_("Files").ToStdString(), 1);
+    m_stats.set(_("Files").ToStdString(), 1);
 
     int         line_no = 0;
     std::string s;
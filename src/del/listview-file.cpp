@@ -39,8 +39,6 @@ wex::del::file::file(const wex::path& p, const data::listview& data)
 {
   file_load(p);
 
-  Bind(wxEVT_IDLE, &del::file::on_idle, this);
-
   Bind(
     wxEVT_LEFT_DOWN,
     [=, this](wxMouseEvent& event)
@@ -105,8 +103,6 @@ wex::del::file::file(const wex::path& p, const data::listview& data)
 
         log::status("Added") << added << "file(s)";
 
-        Bind(wxEVT_IDLE, &file::on_idle, this);
-
         get_frame()->sync(true);
 
         event.Skip();
@@ -124,8 +120,6 @@ void wex::del::file::add_items(
   const std::string& files,
   data::dir::type_t  flags)
 {
-  Unbind(wxEVT_IDLE, &file::on_idle, this);
-
   m_old_count = GetItemCount();
 
   wex::dir dir(
@@ -164,6 +158,8 @@ void wex::del::file::build_popup_menu(wex::menu& menu)
 
 bool wex::del::file::do_file_load(bool synced)
 {
+  watch_project();
+
   pugi::xml_document doc;
 
   if (const auto result = doc.load_file(
@@ -195,14 +191,11 @@ bool wex::del::file::do_file_load(bool synced)
         if (const std::string value = child.text().get();
             strcmp(child.name(), "file") == 0)
         {
-          listitem(this, wex::path(value)).insert();
+          listitem(this, value).insert();
         }
         else if (strcmp(child.name(), "folder") == 0)
         {
-          listitem(
-            this,
-            wex::path(value),
-            child.attribute("extensions").value())
+          listitem(this, value, child.attribute("extensions").value())
             .insert();
         }
 
@@ -269,6 +262,11 @@ void wex::del::file::do_file_save(bool save_as)
   if (doc.save_file(path().string().c_str()))
   {
     log::info("saved") << path();
+
+    if (save_as)
+    {
+      watch_project();
+    }
   }
   else
   {
@@ -298,12 +296,15 @@ bool wex::del::file::item_from_text(const std::string& text)
   return result;
 }
 
-void wex::del::file::on_idle(wxIdleEvent& event)
+void wex::del::file::watch_project()
 {
-  event.Skip();
-
-  if (IsShown() && GetItemCount() > 0 && config("AllowSync").get(true))
-  {
-    check_sync();
-  }
+  listview::sync_watch(
+    path(),
+    [=, this]
+    {
+      if (IsShown() && GetItemCount() > 0)
+      {
+        check_sync();
+      }
+    });
 }
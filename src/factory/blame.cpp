@@ -9,10 +9,12 @@
 #include <wex/chrono.h>
 #include <wex/config.h>
 #include <wex/log.h>
-#include <wex/regex.h>
 
 namespace wex
 {
+  // The max number of parsed dates kept.
+  const size_t max_times = 10000;
+
   std::string
   build(const std::string& key, const std::string& field, bool first = false)
   {
@@ -37,22 +39,38 @@ wex::blame::blame(const pugi::xml_node& node)
   , m_date_format(node.attribute("date-format").value())
   , m_date_print(node.attribute("date-print").as_uint())
 {
+  if (!m_blame_format.empty())
+  {
+    try
+    {
+      m_regex = std::make_shared<const std::regex>(m_blame_format);
+    }
+    catch (std::exception& e)
+    {
+      log(e) << "blame format:" << m_blame_format;
+    }
+  }
 }
 
 std::tuple<bool, const std::string, wex::lexers::margin_style_t, int>
 wex::blame::get(const std::string& text) const
 {
+  if (m_regex == nullptr)
+  {
+    return {false, std::string(), lexers::margin_style_t::OTHER, 0};
+  }
+
   try
   {
-    if (regex r(m_blame_format); r.search(text) >= 3)
+    if (std::smatch m; std::regex_search(text, m, *m_regex) && m.size() >= 4)
     {
       const std::string info(
-        build("id", r[0], true) + build("author", r[1]) +
-        build("date", r[2].substr(0, m_date_print)));
+        build("id", m[1], true) + build("author", m[2]) +
+        build("date", m.str(3).substr(0, m_date_print)));
 
-      const auto line(r.size() == 4 ? std::stoi(r[3]) - 1 : -1);
+      const auto line(m.size() == 5 ? std::stoi(m[4]) - 1 : -1);
 
-      return {true, info.empty() ? " " : info, get_style(r[2]), line};
+      return {true, info.empty() ? " " : info, get_style(m[3]), line};
     }
   }
   catch (std::exception& e)
@@ -72,7 +90,19 @@ wex::lexers::margin_style_t wex::blame::get_style(const std::string& text) const
     return style;
   }
 
-  if (const auto& [r, t] = chrono(m_date_format).get_time(text); r)
+  auto it = m_times.find(text);
+
+  if (it == m_times.end())
+  {
+    if (m_times.size() >= max_times)
+    {
+      m_times.clear();
+    }
+
+    it = m_times.emplace(text, chrono(m_date_format).get_time(text)).first;
+  }
+
+  if (const auto& [r, t] = it->second; r)
   {
     const time_t now               = time(nullptr);
     const auto   dt                = difftime(now, t);
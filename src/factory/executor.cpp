@@ -0,0 +1,534 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      executor.cpp
+// Purpose:   Implementation of class wex::factory::executor
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/process.hpp>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <wex/factory/executor.h>
+#include <wex/log.h>
+
+namespace bp = boost::process;
+
+namespace wex
+{
+  namespace factory
+  {
+    class executor_job
+    {
+    public:
+      executor_job(
+        const std::string&   exe,
+        const std::string&   input,
+        executor::callback_t f,
+        const std::string&   start_dir)
+        : m_exe(exe)
+        , m_input(input)
+        , m_f(f)
+        , m_start_dir(start_dir)
+      {
+        ;
+      }
+
+      const std::string          m_exe, m_input;
+      const executor::callback_t m_f;
+      const std::string          m_start_dir;
+
+      std::string m_out, m_err;
+      int         m_ec{0};
+
+      // stdout, stderr and exit, the job is finished
+      // when all of them are done
+      std::atomic<int> m_pending{3};
+
+      std::chrono::time_point<std::chrono::steady_clock> m_start;
+
+      // protects the child and cancelled
+      std::mutex                      m_mutex;
+      std::unique_ptr<bp::child>      m_child;
+      std::unique_ptr<bp::async_pipe> m_pipe_out, m_pipe_err;
+      bool                            m_cancelled{false};
+    };
+
+    class executor_imp
+    {
+    public:
+      executor_imp(size_t threads, size_t max_children);
+      ~executor_imp();
+
+      void            cancel(const executor::job_t& job);
+      executor::job_t submit(
+        const std::string&   exe,
+        const std::string&   input,
+        executor::callback_t f,
+        const std::string&   start_dir);
+
+      // Adds the run time of a finished process to the timings.
+      void add_timing(
+        const std::string&        exe,
+        int                       ec,
+        std::chrono::microseconds us);
+
+      const size_t m_max_children;
+
+      mutable std::mutex                     m_mutex;
+      std::deque<executor::job_t>            m_queue;
+      std::vector<executor::job_t>           m_running;
+      std::map<std::string, executor::timing> m_timings;
+
+    private:
+      void done(const executor::job_t& job);
+      void finish(const executor::job_t& job);
+      void start(const executor::job_t& job);
+      void stop(const executor::job_t& job);
+
+      boost::asio::io_context m_ioc;
+      boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+                               m_work;
+      std::vector<std::thread> m_threads;
+    };
+
+    static void callback(const executor::job_t& job)
+    {
+      try
+      {
+        job->m_f(job->m_ec, job->m_out, job->m_err);
+      }
+      catch (std::exception& e)
+      {
+        log(e) << "executor" << job->m_exe;
+      }
+    }
+
+    // Returns the filename of the first word of the command.
+    static std::string tool(const std::string& exe)
+    {
+      return std::filesystem::path(exe.substr(0, exe.find(' ')))
+        .filename()
+        .string();
+    }
+  }; // namespace factory
+};   // namespace wex
+
+wex::factory::executor_imp::executor_imp(size_t threads, size_t max_children)
+  : m_max_children(
+      max_children > 0 ?
+        max_children :
+        std::max<size_t>(2, std::thread::hardware_concurrency()))
+  , m_work(boost::asio::make_work_guard(m_ioc))
+{
+  for (size_t i = 0; i < std::max<size_t>(1, threads); i++)
+  {
+    m_threads.emplace_back(
+      [this]
+      {
+        m_ioc.run();
+      });
+  }
+}
+
+wex::factory::executor_imp::~executor_imp()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_queue.clear();
+
+    for (const auto& job : m_running)
+    {
+      stop(job);
+    }
+  }
+
+  // let the io loop finish the stopped jobs, and then return
+  m_work.reset();
+
+  for (auto& t : m_threads)
+  {
+    t.join();
+  }
+}
+
+void wex::factory::executor_imp::add_timing(
+  const std::string&        exe,
+  int                       ec,
+  std::chrono::microseconds us)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto& t = m_timings[tool(exe)];
+  t.count++;
+  t.failed += (ec != 0 ? 1 : 0);
+  t.total += us;
+  t.max = std::max(t.max, us);
+}
+
+void wex::factory::executor_imp::cancel(const executor::job_t& job)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (const auto& it = std::find(m_queue.begin(), m_queue.end(), job);
+        it != m_queue.end())
+    {
+      m_queue.erase(it);
+
+      job->m_cancelled = true;
+      job->m_ec        = 1;
+      job->m_err       = "cancelled";
+
+      boost::asio::post(
+        m_ioc,
+        [job]
+        {
+          callback(job);
+        });
+
+      return;
+    }
+  }
+
+  stop(job);
+}
+
+void wex::factory::executor_imp::done(const executor::job_t& job)
+{
+  if (--job->m_pending == 0)
+  {
+    finish(job);
+  }
+}
+
+void wex::factory::executor_imp::finish(const executor::job_t& job)
+{
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - job->m_start);
+
+  {
+    std::lock_guard<std::mutex> lock(job->m_mutex);
+
+    if (job->m_cancelled)
+    {
+      job->m_ec = (job->m_ec != 0 ? job->m_ec : 1);
+      job->m_err += (job->m_err.empty() ? "cancelled" : "");
+    }
+
+    if (job->m_child != nullptr)
+    {
+      // the child has exited, do not let it be terminated
+      job->m_child->detach();
+      job->m_child.reset();
+    }
+
+    job->m_pipe_out.reset();
+    job->m_pipe_err.reset();
+  }
+
+  if (job->m_ec != 0)
+  {
+    log("executor") << job->m_exe << "ec:" << job->m_ec << job->m_err;
+  }
+  else
+  {
+    log::debug("executor") << job->m_exe << us.count() << "us";
+  }
+
+  add_timing(job->m_exe, job->m_ec, us);
+
+  executor::job_t next;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_running.erase(
+      std::remove(m_running.begin(), m_running.end(), job),
+      m_running.end());
+
+    if (!m_queue.empty())
+    {
+      next = m_queue.front();
+      m_queue.pop_front();
+      m_running.emplace_back(next);
+    }
+  }
+
+  if (next != nullptr)
+  {
+    boost::asio::post(
+      m_ioc,
+      [this, next]
+      {
+        start(next);
+      });
+  }
+
+  callback(job);
+}
+
+void wex::factory::executor_imp::start(const executor::job_t& job)
+{
+  job->m_start = std::chrono::steady_clock::now();
+
+  try
+  {
+    std::lock_guard<std::mutex> lock(job->m_mutex);
+
+    if (job->m_cancelled)
+    {
+      job->m_ec = 1;
+    }
+    else
+    {
+      job->m_pipe_out = std::make_unique<bp::async_pipe>(m_ioc);
+      job->m_pipe_err = std::make_unique<bp::async_pipe>(m_ioc);
+
+      // stdin is written, and stdout and stderr are read, all async
+      // by the io loop, so a large input or output does not block
+      // on a full pipe.
+      job->m_child = std::make_unique<bp::child>(
+        job->m_exe,
+        bp::start_dir = job->m_start_dir,
+        bp::std_in < boost::asio::buffer(job->m_input),
+        bp::std_out > *job->m_pipe_out,
+        bp::std_err > *job->m_pipe_err,
+        bp::on_exit(
+          [this, job](int exit, const std::error_code&)
+          {
+            job->m_ec = exit;
+            done(job);
+          }),
+        m_ioc);
+
+      for (auto* pipe : {job->m_pipe_out.get(), job->m_pipe_err.get()})
+      {
+        auto& text = (pipe == job->m_pipe_out.get() ? job->m_out : job->m_err);
+
+        boost::asio::async_read(
+          *pipe,
+          boost::asio::dynamic_buffer(text),
+          [this, job](const boost::system::error_code&, size_t)
+          {
+            done(job);
+          });
+      }
+
+      return;
+    }
+  }
+  catch (std::exception& e)
+  {
+    log(e) << job->m_exe;
+    job->m_ec = 1;
+    job->m_out.clear();
+    job->m_err = e.what();
+  }
+
+  finish(job);
+}
+
+void wex::factory::executor_imp::stop(const executor::job_t& job)
+{
+  std::lock_guard<std::mutex> lock(job->m_mutex);
+
+  job->m_cancelled = true;
+
+  if (job->m_child != nullptr)
+  {
+    std::error_code ec;
+    job->m_child->terminate(ec);
+
+    // a grandchild might still keep the pipes open
+    boost::asio::post(
+      m_ioc,
+      [job]
+      {
+        std::lock_guard<std::mutex> lock(job->m_mutex);
+
+        for (auto* pipe : {job->m_pipe_out.get(), job->m_pipe_err.get()})
+        {
+          if (pipe != nullptr)
+          {
+            boost::system::error_code ec;
+            pipe->close(ec);
+          }
+        }
+      });
+  }
+}
+
+wex::factory::executor::job_t wex::factory::executor_imp::submit(
+  const std::string&   exe,
+  const std::string&   input,
+  executor::callback_t f,
+  const std::string&   start_dir)
+{
+  auto job = std::make_shared<executor_job>(exe, input, f, start_dir);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_running.size() >= m_max_children)
+    {
+      m_queue.emplace_back(job);
+      return job;
+    }
+
+    m_running.emplace_back(job);
+  }
+
+  boost::asio::post(
+    m_ioc,
+    [this, job]
+    {
+      start(job);
+    });
+
+  return job;
+}
+
+wex::factory::executor* wex::factory::executor::m_self = nullptr;
+
+wex::factory::executor::executor(size_t threads, size_t max_children)
+  : m_imp(std::make_unique<executor_imp>(threads, max_children))
+{
+}
+
+wex::factory::executor::~executor() = default;
+
+void wex::factory::executor::cancel(const job_t& job)
+{
+  if (job != nullptr)
+  {
+    m_imp->cancel(job);
+  }
+}
+
+wex::factory::executor* wex::factory::executor::get(bool createOnDemand)
+{
+  if (m_self == nullptr && createOnDemand)
+  {
+    m_self = new executor();
+  }
+
+  return m_self;
+}
+
+size_t wex::factory::executor::get_max_children() const
+{
+  return m_imp->m_max_children;
+}
+
+size_t wex::factory::executor::get_queued() const
+{
+  std::lock_guard<std::mutex> lock(m_imp->m_mutex);
+  return m_imp->m_queue.size();
+}
+
+size_t wex::factory::executor::get_running() const
+{
+  std::lock_guard<std::mutex> lock(m_imp->m_mutex);
+  return m_imp->m_running.size();
+}
+
+std::map<std::string, wex::factory::executor::timing>
+wex::factory::executor::get_timings() const
+{
+  std::lock_guard<std::mutex> lock(m_imp->m_mutex);
+  return m_imp->m_timings;
+}
+
+wex::factory::executor* wex::factory::executor::set(executor* executor)
+{
+  auto* old = m_self;
+  m_self    = executor;
+  return old;
+}
+
+wex::factory::executor::job_t wex::factory::executor::submit(
+  const std::string& exe,
+  const std::string& input,
+  callback_t         f,
+  const std::string& start_dir)
+{
+  return m_imp->submit(exe, input, f, start_dir);
+}
+
+int wex::factory::executor::system(
+  const std::string& exe,
+  const std::string& input,
+  std::string&       out,
+  std::string&       err,
+  const std::string& start_dir)
+{
+  // The child is not submitted, but run directly by an io loop
+  // on the calling thread, so it is not queued behind submitted jobs,
+  // not counted against max children, and it can be used from
+  // a callback as well.
+  const auto start = std::chrono::steady_clock::now();
+  int        ec    = 1;
+
+  out.clear();
+  err.clear();
+
+  try
+  {
+    boost::asio::io_context ioc;
+    bp::async_pipe          pipe_out(ioc), pipe_err(ioc);
+
+    bp::child child(
+      exe,
+      bp::start_dir = start_dir,
+      bp::std_in < boost::asio::buffer(input),
+      bp::std_out > pipe_out,
+      bp::std_err > pipe_err,
+      bp::on_exit(
+        [&ec](int exit, const std::error_code&)
+        {
+          ec = exit;
+        }),
+      ioc);
+
+    for (auto* pipe : {&pipe_out, &pipe_err})
+    {
+      boost::asio::async_read(
+        *pipe,
+        boost::asio::dynamic_buffer(pipe == &pipe_out ? out : err),
+        [](const boost::system::error_code&, size_t)
+        {
+          ;
+        });
+    }
+
+    ioc.run();
+
+    // the child has exited, do not let it be terminated
+    child.detach();
+  }
+  catch (std::exception& e)
+  {
+    log(e) << exe;
+    ec = 1;
+    out.clear();
+    err = e.what();
+  }
+
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start);
+
+  m_imp->add_timing(exe, ec, us);
+
+  return ec;
+}
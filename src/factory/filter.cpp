@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      filter.cpp
+// Purpose:   Implementation of class wex::factory::filter
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mutex>
+#include <wex/factory/executor.h>
+#include <wex/factory/filter.h>
+#include <wex/log.h>
+#include <wx/app.h>
+
+namespace wex
+{
+  namespace factory
+  {
+    class filter_state
+    {
+    public:
+      std::mutex      mutex;
+      executor::job_t job;
+      bool            cancelled{false}, finished{false};
+    };
+  }; // namespace factory
+};   // namespace wex
+
+wex::factory::filter::~filter()
+{
+  cancel();
+}
+
+bool wex::factory::filter::async_system(
+  const std::string& exe,
+  const std::string& input,
+  callback_t         f,
+  const std::string& start_dir)
+{
+  cancel();
+
+  m_state = std::make_shared<filter_state>();
+
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+
+  m_state->job = executor::get()->submit(
+    exe,
+    input,
+    [f, state = m_state](int ec, const std::string& out, const std::string& err)
+    {
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->finished = true;
+        state->job.reset();
+      }
+
+      if (wxTheApp != nullptr)
+      {
+        wxTheApp->CallAfter(
+          [=]
+          {
+            // cancel is only done from the main thread as well
+            if (!state->cancelled)
+            {
+              f(ec, out, err);
+            }
+          });
+      }
+    },
+    start_dir);
+
+  return true;
+}
+
+void wex::factory::filter::cancel()
+{
+  if (m_state == nullptr)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+
+  m_state->cancelled = true;
+
+  if (m_state->job != nullptr)
+  {
+    if (auto* e = executor::get(false); e != nullptr)
+    {
+      e->cancel(m_state->job);
+    }
+
+    m_state->job.reset();
+  }
+}
+
+bool wex::factory::filter::is_running() const
+{
+  if (m_state == nullptr)
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+
+  return !m_state->finished && !m_state->cancelled;
+}
+
+int wex::factory::filter::system(
+  const std::string& exe,
+  const std::string& input,
+  const std::string& start_dir)
+{
+  return executor::get()->system(exe, input, m_stdout, m_stderr, start_dir);
+}
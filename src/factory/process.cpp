@@ -9,24 +9,306 @@
 #include <boost/version.hpp>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
-#include <queue>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <wex/defs.h>
+#include <wex/factory/executor.h>
 #include <wex/factory/process.h>
 #include <wex/log.h>
 #include <wx/event.h>
 
 namespace bp = boost::process;
 
+#define WEX_POST(ID, TEXT, DEST)                         \
+  wxCommandEvent event(wxEVT_COMMAND_MENU_SELECTED, ID); \
+  event.SetString(TEXT);                                 \
+  wxPostEvent(DEST, event);
+
 namespace wex::factory
 {
+/// Offers coalescing of the output of a process stream.
+/// The stream is read in blocks, and the output collected is posted
+/// at once, when it is large enough, or after a short time.
+/// Output arriving after a quiet period is posted immediately,
+/// so a prompt is not delayed.
+/// The debug handler (if present) gets each line posted as soon as
+/// it is read.
+class process_output
+{
+public:
+  process_output(int id, wxEvtHandler* out, wxEvtHandler* dbg = nullptr)
+    : m_dbg(dbg)
+    , m_out(out)
+    , m_id(id)
+  {
+    ;
+  }
+
+  /// Reads the stream until it is closed, and posts all output.
+  void run(bp::ipstream& is)
+  {
+    std::thread flusher(
+      [this]
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (!m_done || !m_text.empty())
+        {
+          if (m_text.empty())
+          {
+            m_cv.wait(lock);
+          }
+          else if (
+            !m_done && m_text.size() < c_flush_size &&
+            std::chrono::steady_clock::now() < m_flushed + c_flush_time)
+          {
+            m_cv.wait_until(lock, m_flushed + c_flush_time);
+          }
+          else
+          {
+            std::string text;
+            text.swap(m_text);
+            m_flushed = std::chrono::steady_clock::now();
+            lock.unlock();
+            WEX_POST(m_id, text, m_out)
+            lock.lock();
+          }
+        }
+      });
+
+    std::array<char, 65536> buffer;
+
+    try
+    {
+      for (int n; (n = is.pipe().read(buffer.data(), buffer.size())) > 0;)
+      {
+        add(buffer.data(), n);
+
+        if (m_dbg != nullptr)
+        {
+          post_lines(buffer.data(), n);
+        }
+      }
+    }
+    catch (std::exception& e)
+    {
+      log::debug("process output") << e.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_done = true;
+    }
+
+    m_cv.notify_one();
+    flusher.join();
+  }
+
+private:
+  void add(const char* data, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const bool first = m_text.empty();
+
+    for (const char* end = data + size; data < end;)
+    {
+      const auto* eol =
+        static_cast<const char*>(memchr(data, '\n', end - data));
+      const auto* last = (eol != nullptr ? eol + 1 : end);
+      const size_t line = (eol != nullptr ? eol : end) - data;
+
+      // A too long line is truncated, and continues after the newline.
+      if (m_line_size < c_line_limit)
+      {
+        const auto allowed = std::min(line, c_line_limit - m_line_size);
+        m_text.append(data, allowed);
+
+        if (allowed < line)
+        {
+          m_text.append("\n*** LINE LIMIT ***");
+        }
+      }
+
+      m_line_size += line;
+
+      if (eol != nullptr)
+      {
+        m_text.push_back('\n');
+        m_line_size = 0;
+      }
+
+      data = last;
+    }
+
+    // On first text the flusher posts it, or waits for the time budget.
+    if (first || m_text.size() >= c_flush_size)
+    {
+      m_cv.notify_one();
+    }
+  }
+
+  void post_lines(const char* data, size_t size)
+  {
+    for (const char* end = data + size; data < end;)
+    {
+      const auto* eol =
+        static_cast<const char*>(memchr(data, '\n', end - data));
+      const size_t line = (eol != nullptr ? eol : end) - data;
+
+      // A too long line is truncated, as in add.
+      if (m_line.size() < c_line_limit)
+      {
+        const auto allowed = std::min(line, c_line_limit - m_line.size());
+        m_line.append(data, allowed);
+
+        if (allowed < line)
+        {
+          m_line.append("\n*** LINE LIMIT ***");
+        }
+      }
+
+      if (eol == nullptr)
+      {
+        break;
+      }
+
+      m_line.push_back('\n');
+      WEX_POST(ID_DEBUG_STDOUT, m_line, m_dbg)
+      m_line.clear();
+
+      data = eol + 1;
+    }
+  }
+
+  static constexpr size_t c_flush_size = 65536, c_line_limit = 10000;
+  static constexpr std::chrono::milliseconds c_flush_time{16};
+
+  wxEvtHandler *const m_dbg, *const m_out;
+  const int           m_id;
+
+  std::chrono::steady_clock::time_point m_flushed;
+  std::condition_variable               m_cv;
+  std::mutex                            m_mutex;
+  std::string                           m_line, m_text;
+
+  bool   m_done{false};
+  size_t m_line_size{0};
+};
+
+/// Offers writing input to a process.
+/// Texts are queued, the writer is woken up immediately, and writes
+/// all texts queued at once. The queue is bounded, so if the process
+/// does not read its input, texts are refused.
+class process_input
+{
+public:
+  /// Queues text, returns false if text is refused.
+  bool push(const std::string& text)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      if (m_stop || m_size + text.size() > c_queue_size)
+      {
+        return false;
+      }
+
+      m_queue.emplace_back(text);
+      m_size += text.size();
+    }
+
+    m_cv.notify_one();
+    return true;
+  }
+
+  /// Writes queued texts to the stream until stopped.
+  void run(bp::opstream& os, wxEvtHandler* dbg)
+  {
+    std::vector<std::string> texts;
+
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_cv.wait(
+          lock,
+          [this]
+          {
+            return m_stop || !m_queue.empty();
+          });
+
+        if (m_stop)
+        {
+          return;
+        }
+
+        texts.swap(m_queue);
+        m_size = 0;
+      }
+
+      std::string batch;
+
+      for (const auto& text : texts)
+      {
+        batch.append(text).push_back('\n');
+      }
+
+      if (!os.write(batch.data(), batch.size()).flush())
+      {
+        log("async_system write") << batch;
+        stop();
+        return;
+      }
+
+      for (const auto& text : texts)
+      {
+        log::debug("async_system") << "write:" << text;
+
+        if (dbg != nullptr)
+        {
+          WEX_POST(ID_DEBUG_STDIN, text, dbg)
+        }
+      }
+
+      texts.clear();
+    }
+  }
+
+  /// Stops writing, the texts still queued are skipped.
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+
+    m_cv.notify_one();
+  }
+
+private:
+  static constexpr size_t c_queue_size = 1048576;
+
+  std::condition_variable  m_cv;
+  std::mutex               m_mutex;
+  std::vector<std::string> m_queue;
+
+  bool   m_stop{false};
+  size_t m_size{0};
+};
+
 class process_imp
 {
 public:
   process_imp()
     : m_io(std::make_shared<boost::asio::io_context>())
-    , m_queue(std::make_shared<std::queue<std::string>>())
   {
     ;
   }
@@ -52,6 +334,7 @@ public:
       m_group.terminate();
     }
 
+    m_input->stop();
     m_io->stop();
     m_is_running.store(false);
     return true;
@@ -63,13 +346,19 @@ public:
     {
       return false;
     }
-    m_queue->push(text);
+
+    if (!m_input->push(text))
+    {
+      log("async_system input refused") << text;
+      return false;
+    }
+
     return true;
   }
 
 private:
   std::shared_ptr<boost::asio::io_context> m_io;
-  std::shared_ptr<std::queue<std::string>> m_queue;
+  std::shared_ptr<process_input>           m_input;
 
   std::atomic_bool m_debug{false};
   std::atomic_bool m_is_running{false};
@@ -131,6 +420,16 @@ void wex::factory::process::set_handler_out(wxEvtHandler* eh)
   m_eh_out = eh;
 }
 
+void wex::factory::process::set_system(
+  const std::string& exe,
+  const std::string& out,
+  const std::string& err)
+{
+  m_exe    = exe;
+  m_stdout = out;
+  m_stderr = err;
+}
+
 bool wex::factory::process::stop()
 {
   try
@@ -160,18 +459,12 @@ int wex::factory::process::system(
     const int ec = bp::system(bp::start_dir = start_dir, exe);
     error        = "boost version 1.72 error, please change version";
 #else
-    std::future<std::string> of, ef;
-
-    const int ec = bp::system(
-      bp::start_dir = start_dir,
+    const int ec = executor::get()->system(
       exe,
-      bp::std_out > of,
-      bp::std_err > ef);
-
-    if (of.valid())
-      m_stdout = of.get();
-    if (ef.valid())
-      m_stderr = ef.get();
+      std::string(),
+      m_stdout,
+      m_stderr,
+      start_dir);
 #endif
 
     if (!ec)
@@ -207,29 +500,33 @@ bool wex::factory::process::write(const std::string& text)
   return m_imp->write(text);
 }
 
-#define WEX_POST(ID, TEXT, DEST)                         \
-  wxCommandEvent event(wxEVT_COMMAND_MENU_SELECTED, ID); \
-  event.SetString(TEXT);                                 \
-  wxPostEvent(DEST, event);
-
 void wex::factory::process_imp::async_system(
   const std::string& exe,
   const std::string& start_dir,
   process*           p)
 {
   m_debug.store(p->m_eh_debug != nullptr);
+  m_input = std::make_shared<process_input>();
+
+  if (m_io->stopped())
+  {
+    m_io->restart();
+  }
 
   bp::async_system(
     *m_io.get(),
-    [&](boost::system::error_code error, int i)
+    [this, exe, dbg = p->m_eh_debug, input = m_input](
+      boost::system::error_code error,
+      int                       i)
     {
       m_is_running.store(false);
+      input->stop();
 
       log::debug("async_system") << "exit" << exe;
 
       if (m_debug.load())
       {
-        WEX_POST(ID_DEBUG_EXIT, "", p->m_eh_debug)
+        WEX_POST(ID_DEBUG_EXIT, "", dbg)
       }
     },
 
@@ -245,105 +542,38 @@ void wex::factory::process_imp::async_system(
   m_is_running.store(true);
 
   std::thread t(
-    [debug = m_debug.load(),
-     &dbg  = p->m_eh_debug,
-     &out  = p->m_eh_out,
-     &is   = m_is]
+    [output = std::make_shared<process_output>(
+       ID_SHELL_APPEND,
+       p->m_eh_out,
+       m_debug.load() ? p->m_eh_debug : nullptr),
+     &is = m_is]
     {
-      std::string text, line;
-      line.reserve(1000000);
-      text.reserve(1000000);
-      int  linesize = 0;
-      bool error    = false;
-
-      while (is.good() && !error)
-      {
-        text.push_back(is.get());
-        linesize++;
-
-        if (linesize > 10000)
-        {
-          error = true;
-          WEX_POST(ID_SHELL_APPEND, "\n*** LINE LIMIT ***\n", out)
-        }
-        else if (isspace(text.back()))
-        {
-          WEX_POST(ID_SHELL_APPEND, text, out)
-
-          if (text.back() == '\n')
-          {
-            linesize = 0;
-          }
-
-          if (debug)
-          {
-            line.append(text);
-
-            if (line.back() == '\n')
-            {
-              WEX_POST(ID_DEBUG_STDOUT, line, dbg)
-              line.clear();
-            }
-          }
-
-          text.clear();
-        }
-      }
+      output->run(is);
     });
   t.detach();
 
   std::thread u(
-    [debug = m_debug.load(),
-     io    = m_io,
-     &os   = m_os,
-     dbg   = p->m_eh_debug,
-     queue = m_queue]
+    [io = m_io]
     {
-      while (os.good() && !io->stopped())
-      {
-        io->run_one_for(std::chrono::milliseconds(10));
-
-        if (!queue->empty())
-        {
-          const auto& text(queue->front());
-
-          if (os.good() && !io->stopped())
-          {
-            log::debug("async_system") << "write:" << text;
-
-            os << text << std::endl;
-
-            if (debug)
-            {
-              WEX_POST(ID_DEBUG_STDIN, text, dbg)
-            }
-          }
-          else
-          {
-            log::debug("async_system") << "skip:" << text;
-          }
-
-          queue->pop();
-        }
-      }
+      io->run();
     });
   u.detach();
 
-  std::thread v(
-    [out = p->m_eh_out, &es = m_es]
+  std::thread w(
+    [input = m_input,
+     &os   = m_os,
+     dbg   = m_debug.load() ? p->m_eh_debug : nullptr]
     {
-      std::string text;
-
-      while (es.good())
-      {
-        text.push_back(es.get());
+      input->run(os, dbg);
+    });
+  w.detach();
 
-        if (text.back() == '\n')
-        {
-          WEX_POST(ID_SHELL_APPEND_ERROR, text, out)
-          text.clear();
-        }
-      }
+  std::thread v(
+    [output =
+       std::make_shared<process_output>(ID_SHELL_APPEND_ERROR, p->m_eh_out),
+     &es = m_es]
+    {
+      output->run(es);
     });
   v.detach();
 }
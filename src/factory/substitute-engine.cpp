@@ -0,0 +1,425 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      substitute-engine.cpp
+// Purpose:   Implementation of wex::substitute_engine class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <wex/factory/stc.h>
+#include <wex/log.h>
+#include <wex/substitute-engine.h>
+
+wex::substitute_engine::substitute_engine(
+  const std::string& pattern,
+  const std::string& replacement,
+  substitute_t       flags)
+  : m_flags(flags)
+  , m_pattern(pattern)
+  , m_replacement(replacement)
+{
+  if (m_flags[SUBSTITUTE_REGEX])
+  {
+    try
+    {
+      m_regex = std::make_unique<std::regex>(
+        m_pattern,
+        m_flags[SUBSTITUTE_MATCH_CASE] ?
+          std::regex::ECMAScript :
+          std::regex::ECMAScript | std::regex::icase);
+    }
+    catch (std::exception& e)
+    {
+      log(e) << "substitute_engine" << m_pattern;
+      m_is_ok = false;
+    }
+  }
+}
+
+void wex::substitute_engine::add_regex(
+  std::string&       output,
+  const std::smatch* m,
+  const std::string& replacement) const
+{
+  // Same as scintilla ReplaceTargetRE.
+  for (size_t i = 0; i < replacement.size(); i++)
+  {
+    const auto c = replacement[i];
+
+    if (c != '\\' || i + 1 == replacement.size())
+    {
+      output += c;
+      continue;
+    }
+
+    const auto next = replacement[i + 1];
+
+    if (isdigit(static_cast<unsigned char>(next)))
+    {
+      if (m != nullptr && (size_t)(next - '0') < m->size())
+        output += m->str(next - '0');
+      i++;
+      continue;
+    }
+
+    switch (next)
+    {
+      case 'a':
+        output += '\a';
+        break;
+      case 'b':
+        output += '\b';
+        break;
+      case 'f':
+        output += '\f';
+        break;
+      case 'n':
+        output += '\n';
+        break;
+      case 'r':
+        output += '\r';
+        break;
+      case 't':
+        output += '\t';
+        break;
+      case 'v':
+        output += '\v';
+        break;
+      case '\\':
+        output += '\\';
+        break;
+      default:
+        output += c;
+        continue;
+    }
+
+    i++;
+  }
+}
+
+void wex::substitute_engine::add_replacement(
+  std::string&       output,
+  const std::smatch* m,
+  const std::string& target_org) const
+{
+  if (!m_flags[SUBSTITUTE_VI])
+  {
+    if (m_flags[SUBSTITUTE_REGEX])
+      add_regex(output, m, m_replacement);
+    else
+      output += m_replacement;
+    return;
+  }
+
+  // Using a regex, the vi replacement is built first, and then expanded
+  // as a regex replacement (as build_replacement and ReplaceTargetRE
+  // did), so \\1 is a submatch. The inserted text is escaped, so it is
+  // kept as is.
+  const bool  regex = m_flags[SUBSTITUTE_REGEX];
+  auto        target(target_org);
+  bool        backslash = false;
+  std::string built;
+  auto&       out(regex ? built : output);
+
+  const auto insert = [&out, regex](const std::string& text)
+  {
+    if (!regex)
+    {
+      out += text;
+      return;
+    }
+
+    for (const auto c : text)
+    {
+      if (c == '\\')
+        out += c;
+      out += c;
+    }
+  };
+
+  for (const auto& c : m_replacement)
+  {
+    switch (c)
+    {
+      case '&':
+        !backslash ? insert(target) : insert(std::string(1, c));
+        backslash = false;
+        break;
+
+      case '0':
+      case '1':
+      case '2':
+      case '3':
+      case '4':
+      case '5':
+      case '6':
+      case '7':
+      case '8':
+      case '9':
+        if (!backslash)
+          out += c;
+        else if (c == '0')
+          insert(target);
+        else if (m != nullptr && (size_t)(c - '0') < m->size())
+          insert(m->str(c - '0'));
+        backslash = false;
+        break;
+
+      case 'L':
+      case 'U':
+        if (backslash)
+          c == 'U' ? boost::algorithm::to_upper(target) :
+                     boost::algorithm::to_lower(target);
+        else
+          out += c;
+        backslash = false;
+        break;
+
+      case '\\':
+        if (backslash)
+          out += c;
+        backslash = !backslash;
+        break;
+
+      default:
+        out += c;
+        backslash = false;
+    }
+  }
+
+  if (regex)
+  {
+    add_regex(output, m, built);
+  }
+}
+
+bool wex::substitute_engine::find_literal(
+  const std::string& input,
+  size_t             from,
+  size_t             to,
+  size_t&            pos) const
+{
+  const auto last = input.begin() + to;
+
+  for (auto it = input.begin() + from; it != last;)
+  {
+    it = m_flags[SUBSTITUTE_MATCH_CASE] ?
+           std::search(it, last, m_pattern.begin(), m_pattern.end()) :
+           std::search(
+             it,
+             last,
+             m_pattern.begin(),
+             m_pattern.end(),
+             [](char c1, char c2)
+             {
+               return std::tolower(static_cast<unsigned char>(c1)) ==
+                      std::tolower(static_cast<unsigned char>(c2));
+             });
+
+    if (it == last)
+    {
+      return false;
+    }
+
+    pos = it - input.begin();
+
+    if (
+      !m_flags[SUBSTITUTE_MATCH_WORD] ||
+      ((pos == 0 || !is_word_char(input[pos - 1])) &&
+       (pos + m_pattern.size() == input.size() ||
+        !is_word_char(input[pos + m_pattern.size()]))))
+    {
+      return true;
+    }
+
+    ++it;
+  }
+
+  return false;
+}
+
+bool wex::substitute_engine::is_word_char(char c) const
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+         static_cast<unsigned char>(c) >= 0x80;
+}
+
+int wex::substitute_engine::range(factory::stc* stc, int start, int end)
+{
+  if (!m_is_ok || start > end)
+  {
+    return -1;
+  }
+
+  const auto& b(stc->GetTextRangeRaw(start, end));
+  const std::string input(b.data(), b.length());
+
+  // Map caret and anchor, positions before the range are not touched.
+  const auto  caret  = stc->GetCurrentPos();
+  const auto  anchor = stc->GetAnchor();
+  positions_t positions{
+    caret >= start ? caret - start : -1,
+    anchor >= start ? anchor - start : -1};
+
+  std::string output;
+  const auto  nr = string(input, output, &positions);
+
+  if (nr == 0)
+  {
+    return 0;
+  }
+
+  const auto& front(m_edits.front());
+  const auto& back(m_edits.back());
+  const auto  first_line = stc->LineFromPosition(start + front.in_begin);
+  const auto  last_line  = stc->LineFromPosition(start + back.in_end);
+  const auto  marker     = stc->MarkerNext(first_line + 1, ~0);
+
+  stc->BeginUndoAction();
+
+  // One replace would merge markers of the changed lines into the first
+  // line, so in that case each changed line is replaced.
+  if (first_line == last_line || marker == -1 || marker > last_line)
+  {
+    stc->SetTargetRange(start + front.in_begin, start + back.in_end);
+    stc->ReplaceTargetRaw(
+      output.data() + front.out_begin,
+      back.out_end - front.out_begin);
+  }
+  else
+  {
+    for (auto it = m_edits.rbegin(); it != m_edits.rend(); ++it)
+    {
+      stc->SetTargetRange(start + it->in_begin, start + it->in_end);
+      stc->ReplaceTargetRaw(
+        output.data() + it->out_begin,
+        it->out_end - it->out_begin);
+    }
+  }
+
+  stc->EndUndoAction();
+
+  stc->SetAnchor(positions[1] != -1 ? start + positions[1] : anchor);
+  stc->SetCurrentPos(positions[0] != -1 ? start + positions[0] : caret);
+
+  return nr;
+}
+
+int wex::substitute_engine::string(
+  const std::string& input,
+  std::string&       output,
+  positions_t*       positions)
+{
+  m_edits.clear();
+
+  if (!m_is_ok || m_pattern.empty())
+  {
+    output = input;
+    return 0;
+  }
+
+  output.clear();
+  output.reserve(input.size());
+
+  std::vector<bool> resolved(positions != nullptr ? positions->size() : 0);
+
+  int    nr     = 0;
+  size_t copied = 0;
+  bool   line_edit;
+
+  // Replaces the match from s to e, maps the positions that are
+  // not beyond this match, and keeps the edit for this line.
+  const auto replace = [&](size_t s, size_t e, const std::smatch* m)
+  {
+    output.append(input, copied, s - copied);
+
+    const auto out_s = output.size();
+
+    for (size_t i = 0; i < resolved.size(); i++)
+    {
+      if (auto& p = (*positions)[i];
+          !resolved[i] && p >= 0 && static_cast<size_t>(p) <= e)
+      {
+        p = static_cast<int>(
+          static_cast<size_t>(p) <= s ? p + out_s - s : out_s);
+        resolved[i] = true;
+      }
+    }
+
+    add_replacement(output, m, input.substr(s, e - s));
+
+    if (!line_edit)
+    {
+      m_edits.push_back({s, e, out_s, output.size()});
+      line_edit = true;
+    }
+    else
+    {
+      m_edits.back().in_end  = e;
+      m_edits.back().out_end = output.size();
+    }
+
+    copied = e;
+    nr++;
+  };
+
+  for (size_t line_begin = 0; line_begin <= input.size();)
+  {
+    const auto eol      = input.find_first_of("\r\n", line_begin);
+    const auto line_end = (eol == std::string::npos ? input.size() : eol);
+
+    line_edit = false;
+
+    if (m_regex != nullptr)
+    {
+      for (std::sregex_iterator it(
+             input.begin() + line_begin,
+             input.begin() + line_end,
+             *m_regex);
+           it != std::sregex_iterator();
+           ++it)
+      {
+        const size_t s = it->position(0) + line_begin;
+        replace(s, s + it->length(0), &(*it));
+
+        if (!m_flags[SUBSTITUTE_GLOBAL])
+          break;
+      }
+    }
+    else
+    {
+      for (size_t s = line_begin;
+           find_literal(input, s, line_end, s);
+           s += m_pattern.size())
+      {
+        replace(s, s + m_pattern.size(), nullptr);
+
+        if (!m_flags[SUBSTITUTE_GLOBAL])
+          break;
+      }
+    }
+
+    if (eol == std::string::npos)
+    {
+      break;
+    }
+
+    line_begin =
+      (input[eol] == '\r' && eol + 1 < input.size() && input[eol + 1] == '\n' ?
+         eol + 2 :
+         eol + 1);
+  }
+
+  output.append(input, copied, std::string::npos);
+
+  for (size_t i = 0; i < resolved.size(); i++)
+  {
+    if (auto& p = (*positions)[i]; !resolved[i] && p >= 0)
+    {
+      p += static_cast<int>(output.size()) - static_cast<int>(input.size());
+    }
+  }
+
+  return nr;
+}
@@ -8,7 +8,9 @@
 #include <wex/addressrange.h>
 #include <wex/beautify.h>
 #include <wex/factory/process.h>
+#include <wex/log.h>
 #include <wex/path-lexer.h>
+#include <wex/text-diff.h>
 
 bool wex::beautify::file(const path& p) const
 {
@@ -46,7 +48,7 @@ const std::string wex::beautify::name() const
 
 bool wex::beautify::stc(wex::stc& s) const
 {
-  if (!is_active())
+  if (!is_active() || s.GetReadOnly() || s.is_hexmode())
   {
     return false;
   }
@@ -58,5 +60,46 @@ bool wex::beautify::stc(wex::stc& s) const
         std::to_string(s.LineFromPosition(s.GetSelectionStart()) + 1) + ":" +
         std::to_string(s.LineFromPosition(s.GetSelectionEnd()) + 1));
 
-  return addressrange(&s.get_vi(), "%").escape(name() + lines);
+  const std::string& assume(
+    s.path().empty() ? std::string() :
+                       " --assume-filename=\"" + s.path().string() + "\"");
+
+  // The text is piped to the beautifier, and if the text was not changed
+  // meanwhile, only the changed lines are replaced (as one undo action),
+  // so markers and folds on other lines are kept.
+  return s.get_filter().async_system(
+    name() + lines + assume,
+    s.get_text(),
+    [&s, input = s.get_text(), modifications = s.get_modifications()](
+      int                ec,
+      const std::string& out,
+      const std::string& err)
+    {
+      if (ec != 0 || out.empty())
+      {
+        log::status(_("Beautify failed")) << err;
+      }
+      else if (s.get_modifications() != modifications)
+      {
+        log::status(_("Beautify skipped, text was changed"));
+      }
+      else if (const auto& hunks(text_diff(input, out)); !hunks.empty())
+      {
+        const auto line = s.get_current_line();
+
+        s.BeginUndoAction();
+
+        for (auto it = hunks.rbegin(); it != hunks.rend(); ++it)
+        {
+          s.SetTargetRange(it->begin, it->end);
+          s.ReplaceTargetRaw(
+            out.data() + it->other_begin,
+            it->other_end - it->other_begin);
+        }
+
+        s.EndUndoAction();
+
+        s.goto_line(line);
+      }
+    });
 }
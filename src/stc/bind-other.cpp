@@ -239,6 +239,20 @@ void wex::stc::bind_other()
       }
     });
 
+  Bind(
+    wxEVT_STC_MODIFIED,
+    [=, this](wxStyledTextEvent& event)
+    {
+      event.Skip();
+
+      if (
+        event.GetModificationType() &
+        (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))
+      {
+        m_modifications++;
+      }
+    });
+
   Bind(
     wxEVT_STC_UPDATEUI,
     [=, this](wxStyledTextEvent& event)
@@ -13,6 +13,7 @@
 #include <wex/item-vector.h>
 #include <wex/lexers.h>
 #include <wex/link.h>
+#include <wex/macros.h>
 #include <wex/stc-entry-dialog.h>
 #include <wex/stc.h>
 #include <wx/settings.h>
@@ -124,6 +125,10 @@ void wex::stc::config_get()
 
 void wex::stc::on_exit()
 {
+  // Flush macros changes not yet written, the macros writer does not
+  // flush itself, as the macros are destroyed during static destruction.
+  ex::get_macros().save_document();
+
   if (item_vector(m_config_items).find<bool>(_("stc.Keep zoom")))
   {
     config("stc.zoom").set(m_zoom);
@@ -233,7 +238,13 @@ void wex::stc::on_init()
           std::string("10000000")},
          {_("stc.max.Size lexer"),
           item::TEXTCTRL_INT,
-          std::string("10000000")}}},
+          std::string("10000000")},
+         {_("stc.max.Shell lines"),
+          item::TEXTCTRL_INT,
+          std::string("100000")},
+         {_("stc.max.Size register"),
+          item::TEXTCTRL_INT,
+          std::string("1000000")}}},
        {_("Folding"),
         {{_("stc.Indentation guide"), item::CHECKBOX},
          {_("stc.Auto fold"), 0, INT_MAX, 1500},
@@ -134,6 +134,24 @@ int wex::debug::add_menu(wex::menu* menu, bool popup) const
   return ret;
 }
 
+bool wex::debug::add_breakpoint(
+  const std::string& no,
+  const std::string& file,
+  int                line)
+{
+  if (const auto& filename(complete_path(file)); allow_open(filename))
+  {
+    if (auto* stc = m_frame->open_file(filename); stc != nullptr)
+    {
+      const auto id = stc->MarkerAdd(line - 1, m_marker_breakpoint.number());
+      m_breakpoints[no] = std::make_tuple(filename, id, line - 1);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool wex::debug::allow_open(const path& p) const
 {
   return p.file_exists() &&
@@ -210,10 +228,15 @@ bool wex::debug::execute(const std::string& action, wex::stc* stc)
       return false;
     }
 
-    if (!m_process->is_running() && !m_process->async_system(exe))
+    if (!m_process->is_running())
     {
-      log("debug") << m_entry.name() << "process no execute" << exe;
-      return false;
+      m_mi.reset();
+
+      if (!m_process->async_system(exe))
+      {
+        log("debug") << m_entry.name() << "process no execute" << exe;
+        return false;
+      }
     }
 
     if (regex v(" +([a-zA-Z0-9_./-]*)"); v.search(args) == 1)
@@ -403,8 +426,78 @@ void wex::debug::process_stdin(const std::string& text)
   }
 }
 
+void wex::debug::process_mi(const std::string& text)
+{
+  for (const auto& e : m_mi.feed(text))
+  {
+    switch (e.type)
+    {
+      case mi_parser::event::BREAKPOINT_CREATED:
+        add_breakpoint(e.no, e.file, e.line);
+        break;
+
+      case mi_parser::event::BREAKPOINT_DELETED:
+        if (const auto& it = m_breakpoints.find(e.no);
+            it != m_breakpoints.end())
+        {
+          if (m_frame->is_open(std::get<0>(it->second)))
+          {
+            if (auto* stc = m_frame->open_file(std::get<0>(it->second));
+                stc != nullptr)
+            {
+              stc->MarkerDeleteHandle(std::get<1>(it->second));
+            }
+          }
+          m_breakpoints.erase(it);
+        }
+        break;
+
+      case mi_parser::event::ERROR_MSG:
+        log::status(m_entry.name()) << e.text;
+        break;
+
+      case mi_parser::event::EXITED:
+        is_finished();
+        break;
+
+      case mi_parser::event::PATH:
+        set_exe(e.file);
+        break;
+
+      case mi_parser::event::STOPPED:
+        if (!e.file.empty() && e.line > 0)
+        {
+          m_path                 = complete_path(e.file);
+          m_path_execution_point = m_path;
+
+          if (allow_open(m_path))
+          {
+            data::stc data;
+            data.indicator_no(data::stc::IND_DEBUG);
+            data.control().line(e.line);
+            m_frame->open_file(m_path, data);
+          }
+        }
+        break;
+
+      case mi_parser::event::VARIABLE:
+        show_variable(e.text);
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
 void wex::debug::process_stdout(const std::string& text)
 {
+  if (m_entry.is_mi())
+  {
+    process_mi(text);
+    return;
+  }
+
   m_stdout += text;
 
   log::trace("debug stdout") << m_stdout << m_path;
@@ -414,39 +507,14 @@ void wex::debug::process_stdout(const std::string& text)
   {
     m_stdout.clear();
 
-    if (const auto& filename(complete_path(v[1])); allow_open(filename))
+    if (add_breakpoint(v[0], v[1], std::stoi(v[2])))
     {
-      if (auto* stc = m_frame->open_file(filename); stc != nullptr)
-      {
-        const auto line = std::stoi(v[2]) - 1;
-        const auto id   = stc->MarkerAdd(line, m_marker_breakpoint.number());
-        m_breakpoints[v[0]] = std::make_tuple(filename, id, line);
-        return;
-      }
+      return;
     }
   }
   else if (MATCH(PATH) == 1)
   {
-    if (path(v[0]).is_absolute())
-    {
-      log::trace("debug path") << v[0];
-
-      if (m_path.string() == v[0] && m_process != nullptr)
-      {
-        // Debug same exe as before, so
-        // reapply all breakpoints.
-        for (const auto& it : m_breakpoints)
-        {
-          m_process->write(
-            m_entry.break_set() + " " + std::get<0>(it.second).string() + ":" +
-            std::to_string(std::get<2>(it.second) + 1));
-        }
-      }
-
-      m_path = path(v[0]);
-      m_frame->debug_exe(m_path);
-    }
-
+    set_exe(v[0]);
     m_stdout.clear();
   }
   else if (regex v(
@@ -471,17 +539,9 @@ void wex::debug::process_stdout(const std::string& text)
   {
     m_stdout.clear();
 
-    if (allow_open(m_path))
+    if (show_variable(v[0]))
     {
-      if (auto* stc = m_frame->open_file(m_path); stc != nullptr)
-      {
-        wxCommandEvent event(
-          wxEVT_COMMAND_MENU_SELECTED,
-          ID_EDIT_DEBUG_VARIABLE);
-        event.SetString(v[0]);
-        wxPostEvent(stc, event);
-        return;
-      }
+      return;
     }
   }
   else if (MATCH(EXIT) >= 0)
@@ -513,6 +573,29 @@ void wex::debug::process_stdout(const std::string& text)
   }
 }
 
+void wex::debug::set_exe(const std::string& text)
+{
+  if (path(text).is_absolute())
+  {
+    log::trace("debug path") << text;
+
+    if (m_path.string() == text && m_process != nullptr)
+    {
+      // Debug same exe as before, so
+      // reapply all breakpoints.
+      for (const auto& it : m_breakpoints)
+      {
+        m_process->write(
+          m_entry.break_set() + " " + std::get<0>(it.second).string() + ":" +
+          std::to_string(std::get<2>(it.second) + 1));
+      }
+    }
+
+    m_path = path(text);
+    m_frame->debug_exe(m_path);
+  }
+}
+
 void wex::debug::set_entry(const std::string& debugger)
 {
   if (std::vector<wex::debug_entry> v; menus::load("debug", v))
@@ -571,6 +654,22 @@ bool wex::debug::show_dialog(wxWindow* parent)
   }
 }
 
+bool wex::debug::show_variable(const std::string& text)
+{
+  if (allow_open(m_path))
+  {
+    if (auto* stc = m_frame->open_file(m_path); stc != nullptr)
+    {
+      wxCommandEvent event(wxEVT_COMMAND_MENU_SELECTED, ID_EDIT_DEBUG_VARIABLE);
+      event.SetString(text);
+      wxPostEvent(stc, event);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool wex::debug::toggle_breakpoint(int line, stc* stc)
 {
   if (m_process == nullptr || stc == nullptr)
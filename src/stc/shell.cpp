@@ -33,9 +33,14 @@ wex::shell::shell(
   , m_commands_iterator(m_commands.end())
   , m_commands_save_in_config(100)
   , m_prompt(prompt)
+  , m_append_timer(this)
 {
   // Override defaults from config.
   SetEdgeMode(wxSTC_EDGE_NONE);
+
+  // Style appended output only as far as it is visible,
+  // the rest is styled during idle time.
+  SetIdleStyling(wxSTC_IDLESTYLING_ALL);
   reset_margins(margin_t().set(MARGIN_FOLDING).set(MARGIN_LINENUMBER));
 
   AutoCompSetSeparator(3);
@@ -61,16 +66,25 @@ wex::shell::shell(
       }
     });
 
+  // Process output is collected, and appended once each frame.
+  Bind(
+    wxEVT_TIMER,
+    [=, this](wxTimerEvent& event)
+    {
+      AppendText(wxEmptyString);
+    },
+    m_append_timer.GetId());
+
   bind(this).command(
     {{[=, this](wxCommandEvent& event)
       {
-        AppendText(event.GetString());
+        append_pending(event.GetString());
         get_frame()->output(event.GetString());
       },
       ID_SHELL_APPEND},
      {[=, this](wxCommandEvent& event)
       {
-        AppendText(event.GetString());
+        append_pending(event.GetString());
       },
       ID_SHELL_APPEND_ERROR},
      {[=, this](wxCommandEvent& event)
@@ -292,8 +306,23 @@ wex::shell::~shell() {}
 void wex::shell::AppendText(const wxString& text)
 {
   const bool pos_at_end = (GetCurrentPos() >= GetTextLength());
+  const bool scrolled_up =
+    GetFirstVisibleLine() + LinesOnScreen() <=
+    VisibleFromDocLine(GetLineCount() - 1);
+
+  if (!m_append.empty())
+  {
+    m_append_timer.Stop();
+    m_append += text;
+    stc::AppendText(m_append);
+    m_append.clear();
+  }
+  else
+  {
+    stc::AppendText(text);
+  }
 
-  stc::AppendText(text);
+  trim(scrolled_up);
 
   m_command_start_pos = GetTextLength();
 
@@ -301,8 +330,26 @@ void wex::shell::AppendText(const wxString& text)
 
   if (pos_at_end)
   {
-    DocumentEnd();
-    EnsureCaretVisible();
+    if (!scrolled_up)
+    {
+      DocumentEnd();
+      EnsureCaretVisible();
+    }
+    else
+    {
+      // Keep the caret at the end, but do not scroll.
+      SetEmptySelection(GetTextLength());
+    }
+  }
+}
+
+void wex::shell::append_pending(const wxString& text)
+{
+  m_append += text;
+
+  if (!m_append_timer.IsRunning())
+  {
+    m_append_timer.StartOnce(16);
   }
 }
 
@@ -724,3 +771,26 @@ void wex::shell::Undo()
 
   m_command.clear();
 }
+
+void wex::shell::trim(bool scrolled_up)
+{
+  const int max   = config("stc.max.Shell lines").get(100000);
+  const int lines = GetLineCount();
+
+  // Lines are removed in blocks of a tenth of max, so this
+  // is done once in a while, and not for each line appended.
+  if (max <= 0 || lines <= max + std::max(max / 10, 1))
+  {
+    return;
+  }
+
+  const auto remove = lines - max;
+  const auto first  = DocLineFromVisible(GetFirstVisibleLine());
+
+  DeleteRange(0, PositionFromLine(remove));
+
+  if (scrolled_up)
+  {
+    SetFirstVisibleLine(VisibleFromDocLine(std::max(first - remove, 0)));
+  }
+}
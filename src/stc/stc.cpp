@@ -24,6 +24,7 @@
 #include <wex/regex.h>
 #include <wex/stc-entry-dialog.h>
 #include <wex/stc.h>
+#include <wex/substitute-engine.h>
 #include <wex/vcs-entry.h>
 #include <wx/app.h>
 #include <wx/settings.h>
@@ -779,56 +780,82 @@ int wex::stc::replace_all(
   }
 
   int nr_replacements = 0;
-  set_search_flags(-1);
-  BeginUndoAction();
 
-  while (SearchInTarget(find_text) != -1)
+  auto* frd = find_replace_data::get();
+
+  // A rectangular selection or hexmode requires replacing target by target,
+  // as does a find text spanning lines, the engine matches each line.
+  if (
+    !SelectionIsRectangle() && !is_hexmode() &&
+    (frd->is_regex() || find_text.find_first_of("\r\n") == std::string::npos))
+  {
+    substitute_engine::substitute_t flags;
+    flags.set(substitute_engine::SUBSTITUTE_GLOBAL);
+    flags.set(substitute_engine::SUBSTITUTE_MATCH_CASE, frd->match_case());
+    flags.set(
+      substitute_engine::SUBSTITUTE_MATCH_WORD,
+      frd->match_word() && !frd->is_regex());
+    flags.set(substitute_engine::SUBSTITUTE_REGEX, frd->is_regex());
+
+    nr_replacements = std::max(
+      substitute_engine(find_text, replace_text, flags)
+        .range(this, GetTargetStart(), GetTargetEnd()),
+      0);
+  }
+  else
   {
-    bool skip_replace = false;
+    set_search_flags(-1);
+    BeginUndoAction();
 
-    // Check that the target is within the rectangular selection.
-    // If not just continue without replacing.
-    if (SelectionIsRectangle())
+    while (SearchInTarget(find_text) != -1)
     {
-      const auto line      = LineFromPosition(GetTargetStart());
-      const auto start_pos = GetLineSelStartPosition(line);
-      const auto end_pos   = GetLineSelEndPosition(line);
-      const auto length    = GetTargetEnd() - GetTargetStart();
-
-      if (
-        start_pos == wxSTC_INVALID_POSITION ||
-        end_pos == wxSTC_INVALID_POSITION || GetTargetStart() < start_pos ||
-        GetTargetStart() + length > end_pos)
+      bool skip_replace = false;
+
+      // Check that the target is within the rectangular selection.
+      // If not just continue without replacing.
+      if (SelectionIsRectangle())
       {
-        skip_replace = true;
+        const auto line      = LineFromPosition(GetTargetStart());
+        const auto start_pos = GetLineSelStartPosition(line);
+        const auto end_pos   = GetLineSelEndPosition(line);
+        const auto length    = GetTargetEnd() - GetTargetStart();
+
+        if (
+          start_pos == wxSTC_INVALID_POSITION ||
+          end_pos == wxSTC_INVALID_POSITION || GetTargetStart() < start_pos ||
+          GetTargetStart() + length > end_pos)
+        {
+          skip_replace = true;
+        }
       }
-    }
 
-    if (!skip_replace)
-    {
-      if (is_hexmode())
+      if (!skip_replace)
       {
-        m_hexmode.replace_target(replace_text);
+        if (is_hexmode())
+        {
+          m_hexmode.replace_target(replace_text);
+        }
+        else
+        {
+          find_replace_data::get()->is_regex() ?
+            ReplaceTargetRE(replace_text) :
+            ReplaceTarget(replace_text);
+        }
+
+        nr_replacements++;
       }
-      else
+
+      SetTargetRange(GetTargetEnd(), GetLength() - selection_from_end);
+
+      if (GetTargetStart() >= GetTargetEnd())
       {
-        find_replace_data::get()->is_regex() ? ReplaceTargetRE(replace_text) :
-                                               ReplaceTarget(replace_text);
+        break;
       }
-
-      nr_replacements++;
     }
 
-    SetTargetRange(GetTargetEnd(), GetLength() - selection_from_end);
-
-    if (GetTargetStart() >= GetTargetEnd())
-    {
-      break;
-    }
+    EndUndoAction();
   }
 
-  EndUndoAction();
-
   log::status(_("Replaced"))
     << nr_replacements << "occurrences of" << find_text;
 
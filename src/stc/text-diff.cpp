@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      text-diff.cpp
+// Purpose:   Implementation of wex::text_diff
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <wex/text-diff.h>
+
+namespace wex
+{
+// Returns the begin position of each line, followed by the text size.
+std::vector<size_t> line_begins(const std::string_view& text)
+{
+  std::vector<size_t> v{0};
+
+  for (size_t pos = 0; pos < text.size();)
+  {
+    const auto nl = text.find('\n', pos);
+    pos           = (nl == std::string_view::npos ? text.size() : nl + 1);
+    v.emplace_back(pos);
+  }
+
+  return v;
+}
+
+// Returns a line, using the begin positions.
+std::string_view line_at(
+  const std::string_view&    text,
+  const std::vector<size_t>& v,
+  size_t                     no)
+{
+  return text.substr(v[no], v[no + 1] - v[no]);
+}
+}; // namespace wex
+
+std::vector<wex::text_hunk> wex::text_diff(
+  const std::string_view& text,
+  const std::string_view& other,
+  size_t                  max)
+{
+  const auto a(line_begins(text)), b(line_begins(other));
+
+  size_t n = a.size() - 1, m = b.size() - 1, first = 0;
+
+  // Skip common leading and trailing lines.
+  while (first < n && first < m &&
+         line_at(text, a, first) == line_at(other, b, first))
+  {
+    first++;
+  }
+
+  while (n > first && m > first &&
+         line_at(text, a, n - 1) == line_at(other, b, m - 1))
+  {
+    n--;
+    m--;
+  }
+
+  if (first == n && first == m)
+  {
+    return {};
+  }
+
+  // The Myers diff on the remaining lines, x is the line in text,
+  // y the line in other, k = x - y the diagonal.
+  const int  x_max = n - first, y_max = m - first;
+  const int  d_max = std::min<int>(max, x_max + y_max);
+  const auto eq    = [&](int x, int y)
+  {
+    return line_at(text, a, first + x) == line_at(other, b, first + y);
+  };
+
+  std::vector<int>              v(2 * d_max + 3, 0);
+  std::vector<std::vector<int>> trace;
+  int                           d_end = -1;
+
+  for (int d = 0; d <= d_max && d_end == -1; d++)
+  {
+    // Keeps the furthest x on diagonals -d .. d of the previous step.
+    trace.emplace_back(v.begin() + d_max + 1 - d, v.begin() + d_max + 2 + d);
+
+    for (int k = -d; k <= d; k += 2)
+    {
+      auto* vk = &v[d_max + 1 + k];
+      int   x  = (k == -d || (k != d && vk[-1] < vk[1]) ? vk[1] : vk[-1] + 1);
+      int   y  = x - k;
+
+      while (x < x_max && y < y_max && eq(x, y))
+      {
+        x++;
+        y++;
+      }
+
+      *vk = x;
+
+      if (x >= x_max && y >= y_max)
+      {
+        d_end = d;
+        break;
+      }
+    }
+  }
+
+  if (d_end == -1)
+  {
+    return {{a[first], a[n], b[first], b[m]}};
+  }
+
+  // Walks back from the end, collecting each insert or delete,
+  // and joins adjacent ones into hunks.
+  std::vector<text_hunk> hunks;
+  int                    x = x_max, y = y_max;
+
+  for (int d = d_end; d > 0; d--)
+  {
+    const auto& vd = trace[d];
+    const auto  at = [&](int k)
+    {
+      return vd[k + d];
+    };
+
+    const int k      = x - y;
+    const int k_prev = (k == -d || (k != d && at(k - 1) < at(k + 1)) ? k + 1 :
+                                                                         k - 1);
+    const int x_prev = at(k_prev), y_prev = x_prev - k_prev;
+
+    // The edit is an insert (a step in y) or a delete (a step in x),
+    // followed by common lines up to (x, y).
+    const bool      insert = (k_prev == k + 1);
+    const text_hunk h{
+      a[first + x_prev],
+      a[first + x_prev + (insert ? 0 : 1)],
+      b[first + y_prev],
+      b[first + y_prev + (insert ? 1 : 0)]};
+
+    if (!hunks.empty() && hunks.back().begin == h.end &&
+        hunks.back().other_begin == h.other_end)
+    {
+      hunks.back().begin       = h.begin;
+      hunks.back().other_begin = h.other_begin;
+    }
+    else
+    {
+      hunks.emplace_back(h);
+    }
+
+    x = x_prev;
+    y = y_prev;
+  }
+
+  std::reverse(hunks.begin(), hunks.end());
+
+  return hunks;
+}
@@ -0,0 +1,313 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      vcs-batch.cpp
+// Purpose:   Implementation of wex::vcs_batch class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <wex/factory/executor.h>
+#include <wex/interruptible.h>
+#include <wex/log.h>
+#include <wex/path-lexer.h>
+#include <wex/vcs-batch.h>
+#include <wx/timer.h>
+#ifndef __WXMSW__
+#include <unistd.h>
+#endif
+
+namespace wex
+{
+/// The state of a running batch, only accessed from the main thread.
+class vcs_batch_state
+{
+public:
+  vcs_batch_state(
+    const vcs_entry&                   entry,
+    const std::vector<vcs_batch::job>& jobs,
+    size_t                             parallel,
+    vcs_batch::callback_t              f,
+    vcs_batch::done_t                  done)
+    : m_entry(entry)
+    , m_jobs(jobs)
+    , m_parallel(parallel)
+    , m_f(f)
+    , m_done(done)
+    , m_ec(jobs.size(), 1)
+    , m_handles(jobs.size())
+    , m_out(jobs.size())
+    , m_err(jobs.size(), "cancelled")
+  {
+    // A cancel is noticed while waiting for the running processes,
+    // these are terminated then.
+    m_timer.Bind(
+      wxEVT_TIMER,
+      [this](wxTimerEvent& event)
+      {
+        if (!m_cancelled && !interruptible::is_running())
+        {
+          cancel();
+        }
+      });
+  }
+
+  /// Submits jobs, as long as less than parallel jobs are running,
+  /// and finishes the batch when all jobs are done.
+  static void start(const std::shared_ptr<vcs_batch_state>& state);
+
+private:
+  void cancel();
+  void finish();
+  void result(
+    size_t             i,
+    int                ec,
+    const std::string& out,
+    const std::string& err);
+
+  const vcs_entry                   m_entry;
+  const std::vector<vcs_batch::job> m_jobs;
+  const size_t                      m_parallel;
+  const vcs_batch::callback_t       m_f;
+  const vcs_batch::done_t           m_done;
+
+  // until a job is finished, it is cancelled
+  std::vector<int>                      m_ec;
+  std::vector<factory::executor::job_t> m_handles;
+  std::vector<std::string>              m_out, m_err;
+  size_t                                m_finished{0}, m_next{0}, m_running{0};
+  bool                                  m_cancelled{false};
+  wxTimer                               m_timer;
+};
+}; // namespace wex
+
+void wex::vcs_batch_state::cancel()
+{
+  m_cancelled = true;
+
+  // jobs not yet submitted are never started
+  m_next = m_jobs.size();
+
+  for (auto& it : m_handles)
+  {
+    if (it != nullptr)
+    {
+      factory::executor::get()->cancel(it);
+    }
+  }
+}
+
+void wex::vcs_batch_state::finish()
+{
+  m_timer.Stop();
+
+  std::string out, status;
+  size_t      failed = 0;
+
+  for (size_t i = 0; i < m_jobs.size(); i++)
+  {
+    out += m_out[i];
+
+    if (m_ec[i] == 0)
+    {
+      continue;
+    }
+
+    const auto& err(m_err[i].substr(0, m_err[i].find('\n')));
+
+    for (const auto& file : m_jobs[i].files)
+    {
+      status += file.string() + ": " + err + "\n";
+      failed++;
+    }
+  }
+
+  if (!m_cancelled)
+  {
+    interruptible::stop();
+  }
+
+  log::status(m_cancelled ? _("Cancelled") : _("Ready"))
+    << m_entry.get_command().get_command() << "files:" << m_jobs.size()
+    << "failed:" << failed;
+
+  if (m_done != nullptr)
+  {
+    vcs_entry entry(m_entry);
+    entry.set_system(
+      !m_jobs.empty() ? m_jobs.front().exe : std::string(),
+      out + status,
+      status);
+    m_done(entry);
+  }
+}
+
+void wex::vcs_batch_state::result(
+  size_t             i,
+  int                ec,
+  const std::string& out,
+  const std::string& err)
+{
+  m_handles[i].reset();
+  m_running--;
+  m_finished++;
+
+  m_ec[i]  = ec;
+  m_out[i] = out;
+  m_err[i] = err;
+
+  if (!m_cancelled && !interruptible::is_running())
+  {
+    cancel();
+  }
+
+  if (!m_cancelled)
+  {
+    log::status(m_entry.get_command().get_command())
+      << m_finished << "/" << m_jobs.size();
+
+    if (m_f != nullptr)
+    {
+      vcs_entry entry(m_entry);
+
+      if (m_jobs[i].files.size() == 1)
+      {
+        entry.m_lexer = path_lexer(m_jobs[i].files.front()).lexer();
+      }
+
+      entry.set_system(m_jobs[i].exe, out, err);
+      m_f(m_jobs[i].files, entry);
+    }
+  }
+}
+
+void wex::vcs_batch_state::start(const std::shared_ptr<vcs_batch_state>& state)
+{
+  for (; state->m_next < state->m_jobs.size() &&
+         state->m_running < state->m_parallel;
+       state->m_next++)
+  {
+    const auto  i = state->m_next;
+    const auto& job(state->m_jobs[i]);
+
+    state->m_running++;
+    state->m_handles[i] = factory::executor::get()->submit(
+      job.exe,
+      std::string(),
+      [state, i](int ec, const std::string& out, const std::string& err)
+      {
+        wxTheApp->CallAfter(
+          [=]
+          {
+            state->result(i, ec, out, err);
+            start(state);
+          });
+      },
+      job.wd);
+  }
+
+  if (state->m_running == 0 && state->m_next == state->m_jobs.size())
+  {
+    state->finish();
+  }
+  else if (!state->m_timer.IsRunning())
+  {
+    state->m_timer.Start(100);
+  }
+}
+
+wex::vcs_batch::vcs_batch(
+  const vcs_entry&         entry,
+  const std::vector<path>& files,
+  size_t                   max_size)
+  : m_entry(entry)
+  , m_parallel(entry.get_command().is_open())
+{
+  if (m_parallel)
+  {
+    for (const auto& file : files)
+    {
+      // git uses the filename relative to the working dir,
+      // as in vcs execute
+      m_jobs.push_back(
+        {{file},
+         m_entry.command_line(
+           "\"" +
+           (entry.name() == "git" ? file.filename() : file.string()) +
+           "\""),
+         file.parent_path()});
+    }
+
+    return;
+  }
+
+  const auto max(max_size > 0 ? max_size : max_command_size());
+  const auto base(m_entry.command_line().size());
+
+  std::vector<path> group;
+  std::string       args;
+
+  const auto flush = [&]
+  {
+    if (!group.empty())
+    {
+      m_jobs.push_back(
+        {group, m_entry.command_line(args), group.front().parent_path()});
+      group.clear();
+      args.clear();
+    }
+  };
+
+  for (const auto& file : files)
+  {
+    const std::string arg("\"" + file.string() + "\" ");
+
+    if (!group.empty() && base + args.size() + arg.size() > max)
+    {
+      flush();
+    }
+
+    group.emplace_back(file);
+    args += arg;
+  }
+
+  flush();
+}
+
+bool wex::vcs_batch::execute(callback_t f, done_t done) const
+{
+  if (m_jobs.empty() || !interruptible::start())
+  {
+    return false;
+  }
+
+  vcs_batch_state::start(std::make_shared<vcs_batch_state>(
+    m_entry,
+    m_jobs,
+    m_parallel ? max_parallel() : 1,
+    f,
+    done));
+
+  return true;
+}
+
+size_t wex::vcs_batch::max_command_size()
+{
+#ifdef __WXMSW__
+  // the limit of CreateProcess
+  return 32000;
+#else
+  // the environment is part of the limit as well
+  const auto max = sysconf(_SC_ARG_MAX);
+  return max > 0 ? max / 2 : 4096;
+#endif
+}
+
+size_t wex::vcs_batch::max_parallel()
+{
+  const auto max(factory::executor::get()->get_max_children());
+  return max > 1 ? max - 1 : 1;
+}
@@ -7,6 +7,10 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/tokenizer.hpp>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <wex/config.h>
 #include <wex/log.h>
 #include <wex/menu.h>
@@ -15,6 +19,276 @@
 #include <wex/util.h>
 #include <wex/vcs-entry.h>
 
+namespace wex
+{
+namespace
+{
+// Returns the git metadata dir for the working dir, or an empty path
+// if not present, or if it is a gitdir file (e.g. a worktree).
+std::filesystem::path git_dir(const std::string& wd)
+{
+  std::error_code ec;
+
+  for (auto dir = std::filesystem::absolute(
+         wd.empty() ? std::filesystem::current_path(ec) :
+                      std::filesystem::path(wd),
+         ec);
+       !dir.empty();
+       dir = dir.parent_path())
+  {
+    if (const auto admin(dir / ".git"); std::filesystem::exists(admin, ec))
+    {
+      return std::filesystem::is_directory(admin, ec) ?
+               admin :
+               std::filesystem::path();
+    }
+
+    if (dir == dir.root_path())
+    {
+      break;
+    }
+  }
+
+  return std::filesystem::path();
+}
+
+// Reads the current branch from the git metadata, without running git.
+// Returns false if the metadata is not as expected (e.g. a worktree,
+// or a detached HEAD), then git itself should be used.
+bool git_branch(const std::string& wd, std::string& branch)
+{
+  struct head_t
+  {
+    std::filesystem::file_time_type time;
+    std::string                     branch;
+  };
+
+  // The branch for each HEAD file, valid as long as HEAD is not modified.
+  static std::map<std::filesystem::path, head_t> heads;
+  static std::mutex                              mutex;
+
+  const auto git(git_dir(wd));
+
+  if (git.empty())
+  {
+    return false;
+  }
+
+  std::error_code ec;
+  const auto      head(git / "HEAD");
+  const auto      time(std::filesystem::last_write_time(head, ec));
+
+  if (ec)
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (const auto& it = heads.find(head);
+      it != heads.end() && it->second.time == time)
+  {
+    branch = it->second.branch;
+    return true;
+  }
+
+  std::string line;
+
+  if (std::ifstream ifs(head); !std::getline(ifs, line))
+  {
+    return false;
+  }
+
+  boost::algorithm::trim_right(line);
+
+  const std::string prefix("ref: refs/heads/");
+
+  if (!line.starts_with(prefix))
+  {
+    return false; // a detached HEAD
+  }
+
+  const auto ref(line.substr(5));
+
+  // A branch without commits (no ref yet) is not shown by git branch,
+  // and is not cached, as its ref is created without modifying HEAD.
+  if (!std::filesystem::exists(git / ref, ec))
+  {
+    bool packed = false;
+
+    for (std::ifstream ifs(git / "packed-refs"); std::getline(ifs, line);)
+    {
+      boost::algorithm::trim_right(line);
+
+      if (
+        line.size() > ref.size() && line.ends_with(ref) &&
+        line[line.size() - ref.size() - 1] == ' ')
+      {
+        packed = true;
+        break;
+      }
+    }
+
+    if (!packed)
+    {
+      branch.clear();
+      return true;
+    }
+  }
+
+  branch      = ref.substr(prefix.size() - 5);
+  heads[head] = {time, branch};
+
+  return true;
+}
+
+// Returns the commit id HEAD refers to, read from the git metadata,
+// or an empty string if it could not be read.
+std::string git_revision(const std::filesystem::path& git)
+{
+  std::string line;
+
+  if (std::ifstream ifs(git / "HEAD"); !std::getline(ifs, line))
+  {
+    return std::string();
+  }
+
+  boost::algorithm::trim_right(line);
+
+  if (!line.starts_with("ref: "))
+  {
+    return line; // a detached HEAD
+  }
+
+  const auto ref(line.substr(5));
+
+  if (std::ifstream ifs(git / ref); std::getline(ifs, line))
+  {
+    return boost::algorithm::trim_right_copy(line);
+  }
+
+  for (std::ifstream ifs(git / "packed-refs"); std::getline(ifs, line);)
+  {
+    boost::algorithm::trim_right(line);
+
+    if (line.size() > ref.size() + 1 && line.ends_with(" " + ref))
+    {
+      return line.substr(0, line.size() - ref.size() - 1);
+    }
+  }
+
+  return std::string();
+}
+
+// The blame output of a file, valid as long as the revision
+// and the file itself are not modified.
+class git_blame_cache
+{
+public:
+  // Returns the key for the command on the quoted file in args,
+  // or an empty key if the output cannot be cached.
+  static std::string key(
+    const std::string& command,
+    const std::string& args,
+    const std::string& wd)
+  {
+    return args.size() > 2 && args.front() == '"' && args.back() == '"' &&
+               args.find('"', 1) == args.size() - 1 ?
+             command + "\n" + wd :
+             std::string();
+  }
+
+  // Returns true and sets output, if present and still valid.
+  static bool find(
+    const std::string& key,
+    const std::string& args,
+    const std::string& wd,
+    std::string&       out)
+  {
+    entry_t e;
+
+    if (!get_entry(args, wd, e))
+    {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (const auto& it = m_entries.find(key);
+        it != m_entries.end() && it->second.revision == e.revision &&
+        it->second.time == e.time && it->second.size == e.size)
+    {
+      out = it->second.out;
+      return true;
+    }
+
+    return false;
+  }
+
+  // Stores the output.
+  static void set(
+    const std::string& key,
+    const std::string& args,
+    const std::string& wd,
+    const std::string& out)
+  {
+    if (entry_t e; get_entry(args, wd, e))
+    {
+      e.out = out;
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      if (m_entries.size() >= m_max_entries)
+      {
+        m_entries.clear();
+      }
+
+      m_entries[key] = std::move(e);
+    }
+  }
+
+private:
+  struct entry_t
+  {
+    std::string                     revision;
+    std::filesystem::file_time_type time;
+    uintmax_t                       size{0};
+    std::string                     out;
+  };
+
+  // Gets the current revision, time and size of the file.
+  static bool
+  get_entry(const std::string& args, const std::string& wd, entry_t& e)
+  {
+    std::error_code ec;
+
+    const auto file(
+      std::filesystem::path(wd) / args.substr(1, args.size() - 2));
+
+    if (const auto git(git_dir(wd)); !git.empty())
+    {
+      e.revision = git_revision(git);
+    }
+
+    e.time = std::filesystem::last_write_time(file, ec);
+
+    if (e.revision.empty() || ec)
+    {
+      return false;
+    }
+
+    e.size = std::filesystem::file_size(file, ec);
+
+    return !ec;
+  }
+
+  static inline const size_t                   m_max_entries = 100;
+  static inline std::map<std::string, entry_t> m_entries;
+  static inline std::mutex                     m_mutex;
+};
+}; // namespace
+}; // namespace wex
+
 wex::vcs_entry::vcs_entry(const pugi::xml_node& node)
   : process()
   , menu_commands(node)
@@ -40,13 +314,8 @@ size_t wex::vcs_entry::build_menu(int base_id, menu* menu) const
   return menus::build_menu(get_commands(), base_id, menu);
 }
 
-bool wex::vcs_entry::execute(
-  const std::string& args,
-  const lexer&       lexer,
-  const std::string& wd)
+const std::string wex::vcs_entry::command_line(const std::string& args) const
 {
-  m_lexer = lexer;
-
   std::string prefix;
 
   if (m_flags_location == FLAGS_LOCATION_PREFIX)
@@ -107,10 +376,46 @@ bool wex::vcs_entry::execute(
     my_args.clear();
   }
 
-  return process::system(
-           bin() + " " + prefix + get_command().get_command() + " " +
-             subcommand + flags + comment + my_args,
-           wd) == 0;
+  return bin() + " " + prefix + get_command().get_command() + " " +
+         subcommand + flags + comment + my_args;
+}
+
+bool wex::vcs_entry::execute(
+  const std::string& args,
+  const lexer&       lexer,
+  const std::string& wd)
+{
+  m_lexer = lexer;
+
+  const auto command(command_line(args));
+
+  if (!get_command().is_blame() || name() != "git")
+  {
+    return process::system(command, wd) == 0;
+  }
+
+  // Blaming the same file again on the same revision gives the same
+  // output, so it is taken from the cache.
+  const auto key(git_blame_cache::key(command, args, wd));
+
+  if (std::string out;
+      !key.empty() && git_blame_cache::find(key, args, wd, out))
+  {
+    set_system(command, out, std::string());
+    return true;
+  }
+
+  if (process::system(command, wd) != 0)
+  {
+    return false;
+  }
+
+  if (!key.empty())
+  {
+    git_blame_cache::set(key, args, wd, get_stdout());
+  }
+
+  return true;
 }
 
 bool wex::vcs_entry::execute(const std::string& command, const std::string& wd)
@@ -131,7 +436,11 @@ const std::string wex::vcs_entry::get_branch(const std::string& wd) const
 {
   if (name() == "git")
   {
-    if (process p; p.system(bin() + " branch", wd) == 0)
+    if (std::string branch; git_branch(wd, branch))
+    {
+      return branch;
+    }
+    else if (process p; p.system(bin() + " branch", wd) == 0)
     {
       for (const auto& it : boost::tokenizer<boost::char_separator<char>>(
              p.get_stdout(),
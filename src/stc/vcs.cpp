@@ -5,7 +5,9 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <filesystem>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <wx/wxprec.h>
 #ifndef WX_PRECOMP
@@ -16,6 +18,7 @@
 #include <wex/menus.h>
 #include <wex/path-lexer.h>
 #include <wex/util.h>
+#include <wex/vcs-batch.h>
 #include <wex/vcs.h>
 
 #define SET_ENTRY                                                \
@@ -41,6 +44,9 @@ enum
 };
 
 /// Offers several vcs admin support methods.
+/// The toplevel dirs are cached for each dir, including dirs
+/// without a toplevel, so looking up several files in the same dir
+/// walks the dir components only once.
 class vcs_admin
 {
 public:
@@ -51,14 +57,16 @@ public:
   {
   }
 
-  /// Returns true if admin dir exists for path.
-  bool exists() const
+  /// Clears the cache, e.g. after running a vcs command that
+  /// might have created or removed an admin dir.
+  static void clear()
   {
-    return !m_dir.empty() && !m_path.empty() &&
-           path(m_path).append(path(m_dir)).dir_exists();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_toplevels.clear();
   }
 
-  /// Returns true if toplevel is not empty.
+  /// Returns true if toplevel is not empty, this is also the case
+  /// if admin dir exists for path itself.
   bool is_toplevel() const { return !toplevel().empty(); }
 
   /// Return toplevel dir.
@@ -67,22 +75,69 @@ public:
     // .git
     // /home/user/wex/src/src/vi.cpp
     // should return -> /home/user/wex
-    path root;
+    if (m_dir.empty() || m_path.empty())
+    {
+      return path();
+    }
+
+    const auto& p(m_path.data());
 
-    for (const auto& part : m_path.data())
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (const auto& it = m_toplevels.find({m_dir, p}); it != m_toplevels.end())
     {
-      if (vcs_admin(m_dir, root.append(part)).exists())
-      {
-        return root;
-      }
+      return path(it->second);
     }
 
-    return path();
+    // An admin dir is never present in a file, so for a file
+    // its parent dir is used.
+    std::error_code ec;
+    const auto&     result(
+      toplevel(std::filesystem::is_directory(p, ec) ? p : p.parent_path()));
+
+    m_toplevels.insert({{m_dir, p}, result});
+
+    return path(result);
   }
 
 private:
+  // The toplevel is the outermost dir containing the admin dir.
+  std::filesystem::path toplevel(const std::filesystem::path& dir) const
+  {
+    if (dir.empty())
+    {
+      return std::filesystem::path();
+    }
+
+    if (const auto& it = m_toplevels.find({m_dir, dir});
+        it != m_toplevels.end())
+    {
+      return it->second;
+    }
+
+    auto result(
+      dir.has_relative_path() ? toplevel(dir.parent_path()) :
+                                std::filesystem::path());
+
+    if (std::error_code ec;
+        result.empty() && std::filesystem::is_directory(dir / m_dir, ec))
+    {
+      result = dir;
+    }
+
+    m_toplevels.insert({{m_dir, dir}, result});
+
+    return result;
+  }
+
   const std::string m_dir;
   const path        m_path;
+
+  static inline std::map<
+    std::pair<std::string, std::filesystem::path>,
+    std::filesystem::path>
+                           m_toplevels;
+  static inline std::mutex m_mutex;
 };
 
 const vcs_entry find_entry(const std::vector<vcs_entry>& entries, const path& p)
@@ -93,13 +148,7 @@ const vcs_entry find_entry(const std::vector<vcs_entry>& entries, const path& p)
     {
       for (const auto& it : entries)
       {
-        const vcs_admin va(it.admin_dir(), p);
-
-        if (va.is_toplevel())
-        {
-          return it;
-        }
-        else if (va.exists())
+        if (vcs_admin(it.admin_dir(), p).is_toplevel())
         {
           return it;
         }
@@ -226,19 +275,14 @@ const wex::path wex::vcs::current_path() const
 
 bool wex::vcs::dir_exists(const wex::path& filename)
 {
-  if (const vcs_entry entry(find_entry(m_entries, filename));
-      vcs_admin(entry.admin_dir(), filename).is_toplevel())
-  {
-    return true;
-  }
-  else
-  {
-    return vcs_admin(entry.admin_dir(), filename).exists();
-  }
+  return vcs_admin(find_entry(m_entries, filename).admin_dir(), filename)
+    .is_toplevel();
 }
 
 bool wex::vcs::execute()
 {
+  vcs_admin::clear();
+
   if (current_path().empty())
   {
     return m_entry.execute(
@@ -255,14 +299,14 @@ bool wex::vcs::execute()
 
     if (m_files.size() > 1)
     {
-      args = clipboard_add(std::accumulate(
+      args = std::accumulate(
         m_files.begin(),
         m_files.end(),
         std::string(),
         [](const std::string& a, const wex::path& b)
         {
           return a + "\"" + b.string() + "\" ";
-        }));
+        });
     }
     else if (m_entry.name() == "git")
     {
@@ -287,6 +331,8 @@ bool wex::vcs::execute()
 
 bool wex::vcs::execute(const std::string& command)
 {
+  vcs_admin::clear();
+
   return m_entry.execute(command, current_path().parent_path());
 }
 
@@ -303,6 +349,8 @@ bool wex::vcs::load_document()
 {
   const auto old_entries = m_entries.size();
 
+  vcs_admin::clear();
+
   if (!menus::load("vcs", m_entries))
     return false;
 
@@ -495,25 +543,42 @@ void wex::vcs_execute(
   {
     if (vcs.show_dialog() == wxID_OK)
     {
-      for (const auto& it : files)
-      {
-        if (wex::vcs vcs({it}, id); vcs.execute())
-        {
-          if (!vcs.entry().get_stdout().empty())
-          {
-            frame->open_file(it, vcs.entry(), data::stc());
-          }
-          else if (!vcs.entry().get_stderr().empty())
+      vcs_admin::clear();
+
+      // each file is opened when its process is finished
+      vcs_batch(vcs.entry(), files)
+        .execute(
+          [frame](const std::vector<path>& paths, const vcs_entry& entry)
           {
-            log() << vcs.entry().get_stderr();
-          }
-          else
+            if (!entry.get_stdout().empty())
+            {
+              frame->open_file(paths.front(), entry, data::stc());
+            }
+            else if (!entry.get_stderr().empty())
+            {
+              log() << entry.get_stderr();
+            }
+            else
+            {
+              log::status("No output");
+              log::debug("no output from") << entry.get_exe();
+            }
+          });
+    }
+  }
+  else if (files.size() > 1)
+  {
+    if (vcs.show_dialog() == wxID_OK)
+    {
+      vcs_admin::clear();
+
+      vcs_batch(vcs.entry(), files)
+        .execute(
+          nullptr,
+          [](const vcs_entry& entry)
           {
-            log::status("No output");
-            log::debug("no output from") << vcs.entry().get_exe();
-          }
-        }
-      }
+            entry.show_output();
+          });
     }
   }
   else
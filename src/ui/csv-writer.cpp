@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      csv-writer.cpp
+// Purpose:   Implementation of wex::csv_writer class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <wex/csv-writer.h>
+#include <wx/wfstream.h>
+#include <wx/zstream.h>
+
+namespace wex
+{
+// The buffer is written when it gets larger than this size.
+const size_t csv_buffer_size = 1024 * 1024;
+}; // namespace wex
+
+wex::csv_writer::csv_writer(const path& p, const data::csv& data)
+  : m_data(data)
+  , m_special({data.delimiter(), data.quote(), '\r', '\n'})
+  , m_file(std::make_unique<wxFileOutputStream>(p.string()))
+  , m_is_ok(m_file->IsOk())
+{
+  if (m_is_ok && m_data.gzip())
+  {
+    m_zlib = std::make_unique<wxZlibOutputStream>(
+      *m_file,
+      wxZ_DEFAULT_COMPRESSION,
+      wxZLIB_GZIP);
+    m_is_ok = m_zlib->IsOk();
+  }
+
+  m_buffer.reserve(csv_buffer_size + 4096);
+}
+
+wex::csv_writer::~csv_writer()
+{
+  close();
+}
+
+void wex::csv_writer::add(const std::string_view& value)
+{
+  if (!m_first)
+  {
+    m_buffer += m_data.delimiter();
+  }
+
+  m_first = false;
+
+  if (m_data.quoting() == data::csv::QUOTE_NONE)
+  {
+    for (const auto c : value)
+    {
+      switch (c)
+      {
+        case '\\':
+          m_buffer += "\\\\";
+          break;
+        case '\r':
+          m_buffer += "\\r";
+          break;
+        case '\n':
+          m_buffer += "\\n";
+          break;
+        default:
+          if (c == m_data.delimiter())
+          {
+            m_buffer += '\\';
+            m_buffer += (c == '\t' ? 't' : c);
+          }
+          else
+          {
+            m_buffer += c;
+          }
+      }
+    }
+
+    return;
+  }
+
+  if (
+    m_data.quoting() == data::csv::QUOTE_MINIMAL &&
+    value.find_first_of(m_special) == std::string_view::npos)
+  {
+    m_buffer += value;
+    return;
+  }
+
+  m_buffer += m_data.quote();
+
+  for (const auto c : value)
+  {
+    if (c == m_data.quote())
+    {
+      m_buffer += c;
+    }
+
+    m_buffer += c;
+  }
+
+  m_buffer += m_data.quote();
+}
+
+bool wex::csv_writer::close()
+{
+  if (m_file == nullptr)
+  {
+    return m_is_ok;
+  }
+
+  flush();
+
+  if (m_zlib != nullptr && !m_zlib->Close())
+  {
+    m_is_ok = false;
+  }
+
+  if (!m_file->Close())
+  {
+    m_is_ok = false;
+  }
+
+  m_zlib.reset();
+  m_file.reset();
+
+  return m_is_ok;
+}
+
+void wex::csv_writer::end_row()
+{
+  m_buffer += '\n';
+  m_first = true;
+
+  if (m_buffer.size() >= csv_buffer_size)
+  {
+    flush();
+  }
+}
+
+void wex::csv_writer::header(const std::vector<std::string>& cols)
+{
+  if (m_data.header())
+  {
+    for (const auto& col : cols)
+    {
+      add(col);
+    }
+
+    end_row();
+  }
+}
+
+bool wex::csv_writer::flush()
+{
+  if (m_is_ok && !m_buffer.empty())
+  {
+    wxOutputStream* os =
+      (m_zlib != nullptr ? static_cast<wxOutputStream*>(m_zlib.get()) :
+                           m_file.get());
+
+    m_is_ok = os->Write(m_buffer.data(), m_buffer.size()).LastWrite() ==
+              m_buffer.size();
+    m_bytes += m_buffer.size();
+  }
+
+  m_buffer.clear();
+
+  return m_is_ok;
+}
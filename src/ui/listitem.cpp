@@ -5,6 +5,7 @@
 // Copyright: (c) 2020 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <filesystem>
 #include <wx/wxprec.h>
 #ifndef WX_PRECOMP
 #include <wx/wx.h>
@@ -19,20 +20,24 @@
 // E.g. the LIST_PROCESS has none of the file columns.
 wex::listitem::listitem(listview* lv, long itemnumber)
   : m_listview(lv)
-  , m_path(
+  , m_file(
       (!lv->get_item_text(itemnumber, _("File Name")).empty() &&
            !lv->get_item_text(itemnumber, _("In Folder")).empty() ?
-         wex::path(
-           wex::path(lv->get_item_text(itemnumber, _("In Folder"))),
-           lv->get_item_text(itemnumber, _("File Name"))) :
-         wex::path(lv->get_item_text(itemnumber))))
+         (std::filesystem::path(
+            lv->get_item_text(itemnumber, _("In Folder"))) /
+          lv->get_item_text(itemnumber, _("File Name")))
+           .string() :
+         lv->get_item_text(itemnumber)))
   , m_file_spec(lv->get_item_text(itemnumber, _("Type")))
 {
   SetId(itemnumber);
 
   if (itemnumber >= 0)
   {
-    m_is_readonly = (m_listview->GetItemData(GetId()) > 0);
+    m_is_readonly =
+      (m_listview->is_virtual() ?
+         m_listview->m_store.get_data(m_listview->store_row(GetId())) :
+         m_listview->GetItemData(GetId())) > 0;
   }
 }
 
@@ -40,8 +45,16 @@ wex::listitem::listitem(
   listview*          listview,
   const wex::path&   filename,
   const std::string& filespec)
+  : listitem(listview, filename.string(), filespec)
+{
+}
+
+wex::listitem::listitem(
+  listview*          listview,
+  const std::string& filename,
+  const std::string& filespec)
   : m_listview(listview)
-  , m_path(filename)
+  , m_file(filename)
   , m_file_spec(filespec)
   , m_is_readonly(false)
 {
@@ -52,20 +65,37 @@ void wex::listitem::insert(long index)
 {
   SetId(index == -1 ? m_listview->GetItemCount() : index);
 
+  // For a file listview the name and folder are taken from the
+  // path string, a worker finds out whether it exists and its type.
+  const bool meta = m_listview->m_meta != nullptr &&
+                    m_listview->InReportView() && !m_listview->is_virtual();
+  const std::filesystem::path p(m_file);
+
   int         col = 0;
-  std::string filename;
+  std::string filename(m_file);
 
   if (m_listview->InReportView())
   {
     col = m_listview->find_column(_("File Name"));
     assert(col >= 0);
-    filename =
-      (m_path.file_exists() || m_path.dir_exists() ? m_path.filename() :
-                                                     m_path.string());
+
+    if (meta)
+    {
+      filename = (p.has_filename() ? p.filename().string() : m_file);
+    }
+    else
+    {
+      filename = (path().stat().is_ok() ? path().filename() : m_file);
+    }
   }
-  else
+
+  if (m_listview->is_virtual())
   {
-    filename = m_path.string();
+    std::vector<std::string> item(col + 1);
+    item[col] = filename;
+    SetId(m_listview->store_insert(item, index));
+    update();
+    return;
   }
 
   if (col == 0)
@@ -76,7 +106,21 @@ void wex::listitem::insert(long index)
 
   m_listview->InsertItem(*this);
 
-  update();
+  if (meta)
+  {
+    // The folder is needed for the path of this item, the other
+    // attributes are set later on.
+    if (p.has_filename() && p.has_parent_path())
+    {
+      set_item(_("In Folder"), p.parent_path().string());
+    }
+
+    m_listview->m_meta->add(GetId(), m_file, m_file_spec);
+  }
+  else
+  {
+    update();
+  }
 
   if (col > 0)
   {
@@ -88,18 +132,38 @@ std::stringstream wex::listitem::log() const
 {
   std::stringstream ss;
 
-  ss << "PATH: " << m_path.string();
+  ss << "PATH: " << m_file;
 
   return ss;
 }
 
+const wex::path& wex::listitem::path() const
+{
+  if (m_path == nullptr)
+  {
+    m_path = std::make_shared<wex::path>(m_file);
+  }
+
+  return *m_path;
+}
+
 bool wex::listitem::set_item(
   const std::string& col_name,
   const std::string& text)
 {
   if (const auto col = m_listview->find_column(col_name); col != -1)
   {
-    if (!m_listview->SetItem(GetId(), col, text))
+    if (m_listview->is_virtual())
+    {
+      if (!m_listview->m_store.set(m_listview->store_row(GetId()), col, text))
+      {
+        log() << *this << "col:" << col << "id:" << GetId() << "text:" << text;
+        return false;
+      }
+
+      m_listview->RefreshItem(GetId());
+    }
+    else if (!m_listview->SetItem(GetId(), col, text))
     {
       log() << *this << "col:" << col << "id:" << GetId() << "text:" << text;
       return false;
@@ -130,10 +194,19 @@ void wex::listitem::set_readonly(bool readonly)
     SetTextColour(config(_("list.Readonly colour")).get(*wxLIGHT_GREY));
   }
 
-  (reinterpret_cast<wxListView*>(m_listview))->SetItem(*this);
-
   // Using GetTextColour did not work, so keep state in boolean.
   m_is_readonly = readonly;
+
+  if (m_listview->is_virtual())
+  {
+    // the colour is taken from the item attributes
+    m_listview->m_store.set_data(
+      m_listview->store_row(GetId()),
+      m_is_readonly);
+    return;
+  }
+
+  (reinterpret_cast<wxListView*>(m_listview))->SetItem(*this);
   m_listview->SetItemData(GetId(), m_is_readonly);
 }
 
@@ -141,23 +214,30 @@ void wex::listitem::update()
 {
   SetImage(
     m_listview->data().image() == data::listview::IMAGE_FILE_ICON &&
-        m_path.stat().is_ok() ?
-      get_iconid(m_path) :
+        path().stat().is_ok() ?
+      get_iconid(path()) :
       -1);
 
-  set_readonly(m_path.stat().is_readonly());
+  set_readonly(path().stat().is_readonly());
 
-  (reinterpret_cast<wxListView*>(m_listview))->SetItem(*this);
+  if (m_listview->is_virtual())
+  {
+    m_listview->set_item_image(GetId(), GetImage());
+  }
+  else
+  {
+    (reinterpret_cast<wxListView*>(m_listview))->SetItem(*this);
+  }
 
-  if (m_listview->InReportView() && m_path.stat().is_ok())
+  if (m_listview->InReportView() && path().stat().is_ok())
   {
-    set_item(_("Type"), m_path.dir_exists() ? m_file_spec : m_path.extension());
-    set_item(_("In Folder"), m_path.parent_path());
-    set_item(_("Modified"), m_path.stat().get_modification_time());
+    set_item(_("Type"), path().dir_exists() ? m_file_spec : path().extension());
+    set_item(_("In Folder"), path().parent_path());
+    set_item(_("Modified"), path().stat().get_modification_time());
 
-    if (m_path.file_exists())
+    if (path().file_exists())
     {
-      set_item(_("Size"), std::to_string(m_path.stat().st_size));
+      set_item(_("Size"), std::to_string(path().stat().st_size));
     }
   }
 }
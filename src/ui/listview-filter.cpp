@@ -0,0 +1,495 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-filter.cpp
+// Purpose:   Implementation of wex::listview_filter class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <boost/algorithm/string.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "listview-filter.h"
+
+namespace wex
+{
+// Returns true if text matches the glob, * matches any text,
+// ? matches any character.
+bool glob_match(std::string_view glob, std::string_view text, bool match_case)
+{
+  const auto is_equal = [match_case](char g, char t)
+  {
+    return g == '?' ||
+           (match_case ? g == t :
+                         std::toupper(static_cast<unsigned char>(g)) ==
+                           std::toupper(static_cast<unsigned char>(t)));
+  };
+
+  size_t g = 0, t = 0, star = std::string_view::npos, mark = 0;
+
+  while (t < text.size())
+  {
+    if (g < glob.size() && glob[g] == '*')
+    {
+      star = g++;
+      mark = t;
+    }
+    else if (g < glob.size() && is_equal(glob[g], text[t]))
+    {
+      g++;
+      t++;
+    }
+    else if (star != std::string_view::npos)
+    {
+      // let the last star match one more character
+      g = star + 1;
+      t = ++mark;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  while (g < glob.size() && glob[g] == '*')
+  {
+    g++;
+  }
+
+  return g == glob.size();
+}
+
+// Returns the longest text between separators.
+std::string longest_part(const std::string& text, const std::string& separators)
+{
+  std::string longest;
+
+  for (const auto& part :
+       boost::tokenizer<boost::char_separator<char>>(
+         text,
+         boost::char_separator<char>(separators.c_str())))
+  {
+    if (part.size() > longest.size())
+    {
+      longest = part;
+    }
+  }
+
+  return longest;
+}
+}; // namespace wex
+
+std::string wex::listview_filter::literal(const std::string& regex)
+{
+  std::string longest, current;
+  int         depth = 0;
+
+  const auto flush = [&]()
+  {
+    if (depth == 0 && current.size() > longest.size())
+    {
+      longest = current;
+    }
+
+    current.clear();
+  };
+
+  for (size_t i = 0; i < regex.size(); i++)
+  {
+    switch (const auto c = regex[i]; c)
+    {
+      case '|':
+        return std::string();
+
+      case '?':
+      case '*':
+      case '{':
+        // the previous character is optional
+        if (!current.empty())
+        {
+          current.pop_back();
+        }
+
+        flush();
+
+        if (c == '{' && (i = regex.find('}', i)) == std::string::npos)
+        {
+          return longest;
+        }
+        break;
+
+      case '[':
+      {
+        flush();
+
+        // skip the class, a ] directly after [ or [^ is part of it
+        auto first = i + 1;
+
+        if (first < regex.size() && regex[first] == '^')
+        {
+          first++;
+        }
+
+        for (i = first; i < regex.size() && (regex[i] != ']' || i == first);
+             i++)
+        {
+          if (regex[i] == '\\')
+          {
+            i++;
+          }
+        }
+      }
+      break;
+
+      case '(':
+        flush();
+        depth++;
+        break;
+
+      case ')':
+        flush();
+        depth--;
+        break;
+
+      case '.':
+      case '^':
+      case '$':
+      case '+':
+        flush();
+        break;
+
+      case '\\':
+        if (
+          i + 1 < regex.size() &&
+          !std::isalnum(static_cast<unsigned char>(regex[i + 1])))
+        {
+          current += regex[++i];
+        }
+        else
+        {
+          // a character class, an anchor, a back reference, or an
+          // escaped character (\xHH, \uHHHH, \cX), skipped with its
+          // digits or letter
+          flush();
+
+          switch (++i < regex.size() ? regex[i] : 0)
+          {
+            case 'c':
+              i += 1;
+              break;
+            case 'u':
+              i += 4;
+              break;
+            case 'x':
+              i += 2;
+              break;
+            default:
+              while (i + 1 < regex.size() &&
+                     std::isdigit(static_cast<unsigned char>(regex[i])) &&
+                     std::isdigit(static_cast<unsigned char>(regex[i + 1])))
+              {
+                i++;
+              }
+          }
+        }
+        break;
+
+      default:
+        current += c;
+    }
+  }
+
+  flush();
+
+  return longest;
+}
+
+wex::listview_filter::listview_filter(
+  const std::vector<column>& cols,
+  const std::string&         text,
+  bool                       regex,
+  bool                       match_case)
+  : m_text(text)
+  , m_match_case(match_case)
+{
+  const auto find_col = [&cols](const std::string& name)
+  {
+    for (size_t i = 0; i < cols.size(); i++)
+    {
+      if (boost::algorithm::iequals(cols[i].GetText().ToStdString(), name))
+      {
+        return static_cast<int>(i);
+      }
+    }
+
+    return -1;
+  };
+
+  if (std::smatch m;
+      std::regex_match(
+        text,
+        m,
+        std::regex("\\s*([^=!<>]+?)\\s*(!=|<=|>=|=|<|>)\\s*(.*)")) &&
+      (m_col = find_col(m[1])) != -1)
+  {
+    m_kind  = COMPARE;
+    m_op    = m[2];
+    m_value = m[3];
+    m_type  = cols[m_col].type();
+
+    if (m_type == column::INT || m_type == column::FLOAT)
+    {
+      char* end;
+      m_number = std::strtod(m_value.c_str(), &end);
+      m_is_ok  = end != m_value.c_str() && *end == 0;
+    }
+    else
+    {
+      if (m_op == "=")
+      {
+        m_literal = m_value;
+      }
+
+      if (!m_match_case)
+      {
+        boost::algorithm::to_upper(m_value);
+      }
+    }
+  }
+  else if (regex)
+  {
+    m_kind = REGEX;
+    m_col  = find_col(_("Line").ToStdString());
+
+    try
+    {
+      m_regex = std::regex(
+        text,
+        match_case ? std::regex::ECMAScript :
+                     std::regex::ECMAScript | std::regex::icase);
+      m_literal = literal(text);
+    }
+    catch (std::regex_error&)
+    {
+      m_is_ok = false;
+    }
+  }
+  else if (text.find_first_of("*?") != std::string::npos)
+  {
+    m_kind       = GLOB;
+    m_value      = text;
+    m_col        = std::max(find_col(_("File Name").ToStdString()), 0);
+    m_col_folder = text.find_first_of("/\\") != std::string::npos ?
+                     find_col(_("In Folder").ToStdString()) :
+                     -1;
+
+    // the folder and file name are different cells
+    m_literal = longest_part(text, "*?/\\");
+  }
+  else
+  {
+    m_literal = text;
+  }
+}
+
+bool wex::listview_filter::is_match(const listview_store& store, size_t row)
+  const
+{
+  switch (m_kind)
+  {
+    case COMPARE:
+    {
+      const auto cell(store.get(row, m_col));
+      int        cmp;
+
+      if (m_type == column::INT)
+      {
+        long long value;
+
+        if (const auto [ptr, ec] =
+              std::from_chars(cell.data(), cell.data() + cell.size(), value);
+            ec != std::errc())
+        {
+          return false;
+        }
+
+        cmp = (value < m_number ? -1 : (value > m_number ? 1 : 0));
+      }
+      else if (m_type == column::FLOAT)
+      {
+        char buffer[64];
+        char* end;
+
+        if (cell.empty() || cell.size() >= sizeof(buffer))
+        {
+          return false;
+        }
+
+        cell.copy(buffer, cell.size());
+        buffer[cell.size()] = 0;
+
+        if (const double value = std::strtod(buffer, &end); end == buffer)
+        {
+          return false;
+        }
+        else
+        {
+          cmp = (value < m_number ? -1 : (value > m_number ? 1 : 0));
+        }
+      }
+      else if (m_match_case)
+      {
+        cmp = cell.compare(m_value);
+      }
+      else
+      {
+        const auto mismatch = std::mismatch(
+          cell.begin(),
+          cell.end(),
+          m_value.begin(),
+          m_value.end(),
+          [](char c, char v)
+          {
+            return std::toupper(static_cast<unsigned char>(c)) == v;
+          });
+
+        cmp = mismatch.first == cell.end() ?
+                (mismatch.second == m_value.end() ? 0 : -1) :
+                (mismatch.second == m_value.end() ?
+                   1 :
+                   std::toupper(static_cast<unsigned char>(*mismatch.first)) -
+                     static_cast<unsigned char>(*mismatch.second));
+      }
+
+      return m_op == "=" ? cmp == 0 :
+             m_op == "!=" ? cmp != 0 :
+             m_op == "<"  ? cmp < 0 :
+             m_op == "<=" ? cmp <= 0 :
+             m_op == ">"  ? cmp > 0 :
+                            cmp >= 0;
+    }
+
+    case GLOB:
+      if (m_col_folder != -1)
+      {
+        thread_local std::string path;
+
+        path.assign(store.get(row, m_col_folder));
+
+        if (!path.empty() && path.back() != '/' && path.back() != '\\')
+        {
+          path += std::filesystem::path::preferred_separator;
+        }
+
+        path.append(store.get(row, m_col));
+
+        return glob_match(m_value, path, m_match_case);
+      }
+
+      return glob_match(m_value, store.get(row, m_col), m_match_case);
+
+    case REGEX:
+      for (size_t col = 0; col < store.columns(); col++)
+      {
+        if (m_col != -1 && static_cast<int>(col) != m_col)
+        {
+          continue;
+        }
+
+        if (const auto cell(store.get(row, col));
+            std::regex_search(cell.begin(), cell.end(), m_regex))
+        {
+          return true;
+        }
+      }
+
+      return false;
+
+    default:
+      // the literal text has been found already
+      return true;
+  }
+}
+
+std::vector<size_t> wex::listview_filter::match(
+  const listview_store&      store,
+  const std::vector<size_t>& rows) const
+{
+  if (!m_is_ok)
+  {
+    return rows;
+  }
+
+  // The rows containing the literal text are taken first, using
+  // the signatures of the store, then these rows are matched.
+  const auto match_part = [this, &store](const std::vector<size_t>& part)
+  {
+    auto found(store.find_all(m_literal, part, m_match_case));
+
+    if (m_kind != CELL)
+    {
+      found.erase(
+        std::remove_if(
+          found.begin(),
+          found.end(),
+          [this, &store](size_t row)
+          {
+            return !is_match(store, row);
+          }),
+        found.end());
+    }
+
+    return found;
+  };
+
+  const size_t parts = std::min<size_t>(
+    std::max(1u, std::thread::hardware_concurrency()),
+    rows.size() / 10000 + 1);
+
+  if (parts == 1)
+  {
+    return match_part(rows);
+  }
+
+  std::vector<std::vector<size_t>> found(parts);
+  std::vector<std::thread>         threads;
+
+  for (size_t i = 0; i < parts; i++)
+  {
+    threads.emplace_back(
+      [&, i]
+      {
+        found[i] = match_part(std::vector<size_t>(
+          rows.begin() + rows.size() * i / parts,
+          rows.begin() + rows.size() * (i + 1) / parts));
+      });
+  }
+
+  std::vector<size_t> result;
+
+  for (size_t i = 0; i < parts; i++)
+  {
+    threads[i].join();
+    result.insert(result.end(), found[i].begin(), found[i].end());
+  }
+
+  return result;
+}
+
+bool wex::listview_filter::narrows(const listview_filter& other) const
+{
+  return m_is_ok && other.m_is_ok && m_kind == CELL && other.m_kind == CELL &&
+         m_match_case == other.m_match_case &&
+         (m_match_case ?
+            m_text.find(other.m_text) != std::string::npos :
+            boost::algorithm::icontains(m_text, other.m_text));
+}
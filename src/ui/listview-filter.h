@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-filter.h
+// Purpose:   Declaration of wex::listview_filter class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <regex>
+#include <string>
+#include <vector>
+#include <wex/factory/listview.h>
+#include <wex/listview-store.h>
+
+namespace wex
+{
+/// Filters the rows of a listview store. The filter text is one of:
+/// - a column name, followed by = != < <= > or >=, and a value,
+///   compares the cells of that column, as number for INT or FLOAT
+///   columns
+/// - a regex (if regex is set), searches the Line column, or all
+///   columns if there is no Line column
+/// - a glob (containing * or ?), matches the path of the row, or its
+///   file name if the glob does not contain a path separator
+/// - otherwise, a text that one of the cells should contain
+class listview_filter
+{
+public:
+  /// Returns the longest literal text that each match of the regex
+  /// contains, or an empty string if there is no such text.
+  static std::string literal(const std::string& regex);
+
+  /// Constructor, parses the text for the columns.
+  listview_filter(
+    const std::vector<column>& cols,
+    const std::string&         text,
+    bool                       regex,
+    bool                       match_case);
+
+  /// Returns true if the text could be parsed.
+  bool is_ok() const { return m_is_ok; }
+
+  /// Returns the rows (taken from rows, in the same order) that match,
+  /// large sets of rows are matched in parallel.
+  std::vector<size_t>
+  match(const listview_store& store, const std::vector<size_t>& rows) const;
+
+  /// Returns true if all rows matching this filter also match other,
+  /// so only the rows matching other need to be matched.
+  bool narrows(const listview_filter& other) const;
+
+  /// Returns the filter text.
+  const auto& text() const { return m_text; }
+
+private:
+  enum kind_t
+  {
+    CELL,
+    COMPARE,
+    GLOB,
+    REGEX
+  };
+
+  bool is_match(const listview_store& store, size_t row) const;
+
+  const std::string m_text;
+  const bool        m_match_case;
+
+  kind_t m_kind{CELL};
+
+  bool m_is_ok{true};
+
+  // the column to use (-1 for all), and its type
+  int            m_col{-1}, m_col_folder{-1};
+  column::type_t m_type{column::STRING};
+
+  // for COMPARE the operator and value, for GLOB the pattern
+  std::string m_op, m_value;
+  double      m_number{0};
+
+  // the text that matching rows must contain
+  std::string m_literal;
+
+  std::regex m_regex;
+};
+}; // namespace wex
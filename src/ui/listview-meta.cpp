@@ -0,0 +1,325 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-meta.cpp
+// Purpose:   Implementation of wex::listview_meta class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <filesystem>
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <wex/chrono.h>
+#include <wex/listview.h>
+#include <wex/stat.h>
+#include <wx/generic/dirctrlg.h> // for wxFileIconsTable
+
+#include "listview-meta.h"
+
+namespace wex
+{
+const std::string item_key(const std::string& folder, const std::string& name)
+{
+  return (std::filesystem::path(folder) / name).string();
+}
+}; // namespace wex
+
+wex::listview_meta::listview_meta(listview* lv)
+  : m_listview(lv)
+{
+}
+
+wex::listview_meta::~listview_meta()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_cv.notify_all();
+
+  for (auto& t : m_workers)
+  {
+    t.join();
+  }
+}
+
+void wex::listview_meta::add(
+  long               item,
+  const std::string& file,
+  const std::string& file_spec)
+{
+  const std::filesystem::path p(file);
+
+  // The name and folder as inserted by the listitem.
+  job j;
+  j.original  = file;
+  j.name      = (p.has_filename() ? p.filename().string() : file);
+  j.folder    = (p.has_filename() ? p.parent_path().string() : std::string());
+  j.file      = item_key(j.folder, j.name);
+  j.file_spec = file_spec;
+  j.item      = item;
+
+  // The item might be inserted before other items.
+  m_index_valid = false;
+
+  if (m_workers.empty())
+  {
+    visible();
+
+    for (size_t i = 0;
+         i < std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+         i++)
+    {
+      m_workers.emplace_back(
+        [this]
+        {
+          run();
+        });
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.emplace(item, std::move(j));
+  }
+
+  m_cv.notify_one();
+}
+
+void wex::listview_meta::apply()
+{
+  std::vector<job> done;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Set a batch each time, so the event loop keeps running.
+    const auto last = m_done.begin() + std::min<size_t>(m_done.size(), 500);
+
+    done.assign(
+      std::make_move_iterator(m_done.begin()),
+      std::make_move_iterator(last));
+    m_done.erase(m_done.begin(), last);
+
+    if (m_done.empty())
+    {
+      m_posted = false;
+    }
+    else
+    {
+      m_listview->CallAfter(
+        [this]
+        {
+          apply();
+        });
+    }
+  }
+
+  // The visible items might have been changed by scrolling.
+  visible();
+
+  m_col_name   = m_listview->find_column(_("File Name"));
+  m_col_folder = m_listview->find_column(_("In Folder"));
+
+  const auto col_type     = m_listview->find_column(_("Type"));
+  const auto col_modified = m_listview->find_column(_("Modified"));
+  const auto col_size     = m_listview->find_column(_("Size"));
+  const auto icon =
+    m_listview->data().image() == data::listview::IMAGE_FILE_ICON;
+  const chrono chr;
+
+  for (const auto& j : done)
+  {
+    const auto item = find(j);
+
+    if (item == -1)
+    {
+      continue;
+    }
+    else if (!j.ok)
+    {
+      // Not an existing file, show the path as it was specified.
+      m_listview->SetItem(item, m_col_name, j.original);
+
+      if (!j.folder.empty())
+      {
+        m_listview->SetItem(item, m_col_folder, std::string());
+      }
+
+      continue;
+    }
+
+    if (icon)
+    {
+      m_listview->SetItemImage(
+        item,
+        j.is_file ? wxFileIconsTable::file :
+                    (j.is_dir ? wxFileIconsTable::folder :
+                                wxFileIconsTable::computer));
+    }
+
+    if (const auto& attr(
+          j.readonly ? m_listview->m_attr_readonly : m_listview->m_attr);
+        attr.HasTextColour())
+    {
+      m_listview->SetItemTextColour(item, attr.GetTextColour());
+    }
+
+    m_listview->SetItemData(item, j.readonly);
+
+    if (col_type != -1)
+    {
+      m_listview->SetItem(
+        item,
+        col_type,
+        j.is_dir ? j.file_spec :
+                   std::filesystem::path(j.name).extension().string());
+    }
+
+    if (col_modified != -1)
+    {
+      m_listview->SetItem(item, col_modified, chr.get_time(j.mtime));
+    }
+
+    if (col_size != -1 && j.is_file)
+    {
+      m_listview->SetItem(item, col_size, std::to_string(j.size));
+    }
+  }
+}
+
+void wex::listview_meta::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_jobs.clear();
+  m_done.clear();
+  m_index.clear();
+  m_index_valid = false;
+}
+
+long wex::listview_meta::find(const job& j)
+{
+  const auto is_item = [this, &j](long item)
+  {
+    return item >= 0 && item < m_listview->GetItemCount() &&
+           m_listview->GetItemText(item, m_col_name) == j.name &&
+           m_listview->GetItemText(item, m_col_folder) == j.folder;
+  };
+
+  if (m_col_name == -1 || m_col_folder == -1)
+  {
+    return -1;
+  }
+  else if (is_item(j.item))
+  {
+    return j.item;
+  }
+
+  // The item has been moved, find it using the index,
+  // that is built once after each change.
+  if (!m_index_valid)
+  {
+    m_index.clear();
+
+    for (long i = 0; i < m_listview->GetItemCount(); i++)
+    {
+      m_index.try_emplace(
+        item_key(
+          m_listview->GetItemText(i, m_col_folder).ToStdString(),
+          m_listview->GetItemText(i, m_col_name).ToStdString()),
+        i);
+    }
+
+    m_index_valid = true;
+  }
+
+  if (const auto& it = m_index.find(j.file);
+      it != m_index.end() && is_item(it->second))
+  {
+    return it->second;
+  }
+
+  return -1;
+}
+
+size_t wex::listview_meta::pending() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  return m_jobs.size() + m_done.size() + m_busy;
+}
+
+void wex::listview_meta::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (true)
+  {
+    m_cv.wait(
+      lock,
+      [this]
+      {
+        return m_stop || !m_jobs.empty();
+      });
+
+    if (m_stop)
+    {
+      return;
+    }
+
+    // The visible items first, then the others in order.
+    auto it = m_jobs.lower_bound(m_top);
+
+    if (it == m_jobs.end() || it->first > m_bottom)
+    {
+      it = m_jobs.begin();
+    }
+
+    auto j(std::move(it->second));
+    m_jobs.erase(it);
+    m_busy++;
+
+    lock.unlock();
+
+    if (const file_stat stat(j.file); stat.is_ok())
+    {
+      j.ok       = true;
+      j.is_file  = (stat.st_mode & S_IFMT) == S_IFREG;
+      j.is_dir   = (stat.st_mode & S_IFMT) == S_IFDIR;
+      j.readonly = stat.is_readonly();
+      j.mtime    = stat.st_mtime;
+      j.size     = stat.st_size;
+    }
+
+    lock.lock();
+
+    m_busy--;
+    m_done.emplace_back(std::move(j));
+
+    // After stopping the listview is being destroyed.
+    if (!m_posted && !m_stop)
+    {
+      m_posted = true;
+      m_listview->CallAfter(
+        [this]
+        {
+          apply();
+        });
+    }
+  }
+}
+
+void wex::listview_meta::visible()
+{
+  const auto top    = m_listview->GetTopItem();
+  const auto bottom = top + m_listview->GetCountPerPage();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_top    = top;
+  m_bottom = bottom;
+}
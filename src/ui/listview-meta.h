@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-meta.h
+// Purpose:   Declaration of wex::listview_meta class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace wex
+{
+class listview;
+
+/// Sets the attributes of file items (image, readonly colour, type,
+/// modified and size) after they are inserted with their name only.
+/// The files are stat on worker threads, the visible items first,
+/// and the results are set in batches from the event loop.
+class listview_meta
+{
+public:
+  /// Constructor.
+  explicit listview_meta(listview* lv);
+
+  /// Destructor, stops the workers.
+  ~listview_meta();
+
+  /// Adds an item for the path string, its attributes are set later on.
+  /// If the path does not exist, the item shows the path string only.
+  void add(long item, const std::string& file, const std::string& file_spec);
+
+  /// Invoke when items are moved or deleted, the items not yet set
+  /// are then looked up by their name and folder.
+  void changed() { m_index_valid = false; }
+
+  /// Removes all items not yet set.
+  void clear();
+
+  /// Returns number of items not yet set.
+  size_t pending() const;
+
+private:
+  // The item to set, and the stat of its file as found by a worker.
+  struct job
+  {
+    std::string file, original, name, folder, file_spec;
+    long        item{-1};
+    bool        ok{false}, is_file{false}, is_dir{false}, readonly{false};
+    time_t      mtime{0};
+    long long   size{0};
+  };
+
+  void apply();
+  long find(const job& j);
+  void run();
+  void visible();
+
+  listview* m_listview;
+
+  std::vector<std::thread>              m_workers;
+  std::multimap<long, job>              m_jobs;
+  std::vector<job>                      m_done;
+  std::unordered_map<std::string, long> m_index;
+
+  mutable std::mutex      m_mutex;
+  std::condition_variable m_cv;
+
+  int  m_col_folder{-1}, m_col_name{-1};
+  long m_top{0}, m_bottom{0};
+  int  m_busy{0};
+  bool m_index_valid{false}, m_posted{false}, m_stop{false};
+};
+}; // namespace wex
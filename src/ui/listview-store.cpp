@@ -0,0 +1,442 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-store.cpp
+// Purpose:   Implementation of class wex::listview_store
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <wex/listview-store.h>
+
+namespace wex
+{
+// Folds a character as boost::algorithm::to_upper does.
+char fold(char c)
+{
+  static const auto table = []
+  {
+    std::array<char, 256> t;
+
+    for (int i = 0; i < 256; i++)
+    {
+      t[i] = static_cast<char>(std::toupper(i));
+    }
+
+    return t;
+  }();
+
+  return table[static_cast<unsigned char>(c)];
+}
+
+// Returns true if all bits of other are set in signature.
+bool contains(
+  const std::array<uint64_t, 4>& signature,
+  const std::array<uint64_t, 4>& other)
+{
+  for (size_t i = 0; i < signature.size(); i++)
+  {
+    if ((signature[i] & other[i]) != other[i])
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Adds the case folded character pairs of text to the signature.
+void sign_text(std::array<uint64_t, 4>& signature, std::string_view text)
+{
+  for (size_t i = 1; i < text.size(); i++)
+  {
+    const uint32_t pair = (static_cast<unsigned char>(fold(text[i - 1])) << 8) |
+                          static_cast<unsigned char>(fold(text[i]));
+    const auto     bit  = (pair * 0x9E3779B1u) >> 24;
+
+    signature[bit >> 6] |= uint64_t(1) << (bit & 63);
+  }
+}
+}; // namespace wex
+
+wex::listview_store::needle::needle(
+  const std::string& t,
+  bool               mcase,
+  bool               mcell)
+  : text(t)
+  , folded(t)
+  , match_case(mcase)
+  , match_cell(mcell)
+{
+  std::transform(folded.begin(), folded.end(), folded.begin(), fold);
+  sign_text(signature, text);
+}
+
+wex::listview_store::cell_t
+wex::listview_store::add(const std::string& text, size_t row, size_t col)
+{
+  if (text.empty())
+  {
+    return 0;
+  }
+
+  // share the text of the cell above
+  if (row > 0 && get(row - 1, col) == text)
+  {
+    return m_cells[col][row - 1];
+  }
+
+  const auto len    = std::min<size_t>(text.size(), 0xFFFFFF);
+  const auto offset = m_arena.size();
+
+  m_arena.append(text, 0, len);
+
+  return (static_cast<cell_t>(offset) << 24) | len;
+}
+
+void wex::listview_store::append_column()
+{
+  m_cells.emplace_back(size(), 0);
+}
+
+void wex::listview_store::clear()
+{
+  m_arena.clear();
+  m_arena.shrink_to_fit();
+  m_garbage = 0;
+
+  for (auto& col : m_cells)
+  {
+    col.clear();
+    col.shrink_to_fit();
+  }
+
+  m_data.clear();
+  m_image.clear();
+  m_signature.clear();
+}
+
+void wex::listview_store::compact()
+{
+  // After a reorder cells sharing text need not be adjacent, so the
+  // distinct cells are collected, and each text is kept once.
+  std::vector<cell_t> cells;
+
+  for (const auto& col : m_cells)
+  {
+    std::copy_if(
+      col.begin(),
+      col.end(),
+      std::back_inserter(cells),
+      [](const auto cell)
+      {
+        return cell != 0;
+      });
+  }
+
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+  size_t live = 0;
+
+  for (const auto cell : cells)
+  {
+    live += length(cell);
+  }
+
+  std::string         arena;
+  std::vector<cell_t> moved;
+  arena.reserve(live);
+  moved.reserve(cells.size());
+
+  for (const auto cell : cells)
+  {
+    const auto offset = arena.size();
+    arena.append(m_arena, cell >> 24, length(cell));
+    moved.emplace_back((static_cast<cell_t>(offset) << 24) | length(cell));
+  }
+
+  for (auto& col : m_cells)
+  {
+    for (auto& cell : col)
+    {
+      if (cell != 0)
+      {
+        cell =
+          moved[std::lower_bound(cells.begin(), cells.end(), cell) -
+                cells.begin()];
+      }
+    }
+  }
+
+  m_arena.swap(arena);
+  m_garbage = 0;
+}
+
+void wex::listview_store::erase(std::vector<size_t> rows)
+{
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+  if (rows.empty())
+  {
+    return;
+  }
+
+  for (const auto row : rows)
+  {
+    for (size_t col = 0; col < columns() && row < size(); col++)
+    {
+      if (!is_shared(row, col))
+      {
+        m_garbage =
+          std::min(m_garbage + length(m_cells[col][row]), m_arena.size());
+      }
+    }
+  }
+
+  // keep the rows that are not erased, in one pass
+  const auto keep = [&rows](auto& v)
+  {
+    size_t to = 0;
+
+    for (size_t from = 0, r = 0; from < v.size(); from++)
+    {
+      if (r < rows.size() && rows[r] == from)
+      {
+        r++;
+      }
+      else
+      {
+        v[to++] = v[from];
+      }
+    }
+
+    v.resize(to);
+  };
+
+  for (auto& col : m_cells)
+  {
+    keep(col);
+  }
+
+  keep(m_data);
+  keep(m_image);
+  keep(m_signature);
+
+  if (m_garbage > m_arena.size() / 2)
+  {
+    compact();
+  }
+}
+
+long wex::listview_store::find(
+  const std::string& text,
+  long               start,
+  bool               forward,
+  bool               match_case,
+  bool               match_cell) const
+{
+  if (text.empty())
+  {
+    return -1;
+  }
+
+  const needle n(text, match_case, match_cell);
+
+  for (long row = start; row >= 0 && row < static_cast<long>(size());
+       forward ? row++ : row--)
+  {
+    if (is_match(row, n))
+    {
+      return row;
+    }
+  }
+
+  return -1;
+}
+
+std::vector<size_t> wex::listview_store::find_all(
+  const std::string&         text,
+  const std::vector<size_t>& rows,
+  bool                       match_case) const
+{
+  const needle        n(text, match_case, false);
+  std::vector<size_t> found;
+
+  for (const auto row : rows)
+  {
+    if (text.empty() || is_match(row, n))
+    {
+      found.emplace_back(row);
+    }
+  }
+
+  return found;
+}
+
+std::string_view wex::listview_store::get(size_t row, size_t col) const
+{
+  if (col >= columns() || row >= size())
+  {
+    return std::string_view();
+  }
+
+  const auto cell = m_cells[col][row];
+
+  return std::string_view(m_arena.data() + (cell >> 24), length(cell));
+}
+
+size_t wex::listview_store::insert(
+  const std::vector<std::string>& cells,
+  long                            index)
+{
+  const size_t row =
+    (index < 0 || static_cast<size_t>(index) > size() ? size() : index);
+
+  for (size_t col = 0; col < columns(); col++)
+  {
+    const auto cell =
+      add(col < cells.size() ? cells[col] : std::string(), row, col);
+    m_cells[col].insert(m_cells[col].begin() + row, cell);
+  }
+
+  m_data.insert(m_data.begin() + row, 0);
+  m_image.insert(m_image.begin() + row, -1);
+  m_signature.insert(m_signature.begin() + row, signature_t{});
+
+  sign(row);
+
+  return row;
+}
+
+bool wex::listview_store::is_match(size_t row, const needle& n) const
+{
+  // Skip the row if a character pair of text is not in the row.
+  if (row >= size() || !contains(m_signature[row], n.signature))
+  {
+    return false;
+  }
+
+  const auto is_folded = [](char c, char f)
+  {
+    return fold(c) == f;
+  };
+
+  for (size_t col = 0; col < columns(); col++)
+  {
+    const auto cell(get(row, col));
+
+    if (n.match_cell ?
+          (n.match_case ? cell == n.text :
+                          cell.size() == n.folded.size() &&
+                            std::equal(
+                              cell.begin(),
+                              cell.end(),
+                              n.folded.begin(),
+                              is_folded)) :
+          (n.match_case ? cell.find(n.text) != std::string_view::npos :
+                          std::search(
+                            cell.begin(),
+                            cell.end(),
+                            n.folded.begin(),
+                            n.folded.end(),
+                            is_folded) != cell.end()))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool wex::listview_store::is_shared(size_t row, size_t col) const
+{
+  const auto& v(m_cells[col]);
+
+  return v[row] == 0 || (row > 0 && v[row - 1] == v[row]) ||
+         (row + 1 < v.size() && v[row + 1] == v[row]);
+}
+
+size_t wex::listview_store::memory() const
+{
+  size_t bytes = m_arena.capacity() + m_data.capacity() * sizeof(long) +
+                 m_image.capacity() * sizeof(int) +
+                 m_signature.capacity() * sizeof(signature_t);
+
+  for (const auto& col : m_cells)
+  {
+    bytes += col.capacity() * sizeof(cell_t);
+  }
+
+  return bytes;
+}
+
+void wex::listview_store::reorder(const std::vector<size_t>& order)
+{
+  if (order.size() != size())
+  {
+    return;
+  }
+
+  const auto apply = [&order](auto& v)
+  {
+    auto copy(v);
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      v[i] = copy[order[i]];
+    }
+  };
+
+  for (auto& col : m_cells)
+  {
+    apply(col);
+  }
+
+  apply(m_data);
+  apply(m_image);
+  apply(m_signature);
+}
+
+bool wex::listview_store::set(size_t row, size_t col, const std::string& text)
+{
+  if (col >= columns() || row >= size())
+  {
+    return false;
+  }
+
+  if (get(row, col) == text)
+  {
+    return true;
+  }
+
+  if (!is_shared(row, col))
+  {
+    m_garbage =
+      std::min(m_garbage + length(m_cells[col][row]), m_arena.size());
+  }
+
+  m_cells[col][row] = add(text, row, col);
+
+  sign(row);
+
+  if (m_garbage > 1024 * 1024 && m_garbage > m_arena.size() / 2)
+  {
+    compact();
+  }
+
+  return true;
+}
+
+void wex::listview_store::sign(size_t row)
+{
+  auto& signature(m_signature[row]);
+  signature.fill(0);
+
+  for (size_t col = 0; col < columns(); col++)
+  {
+    sign_text(signature, get(row, col));
+  }
+}
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      listview-sync.cpp
+// Purpose:   Implementation of wex::listview_sync class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <filesystem>
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <wex/config.h>
+#include <wex/listitem.h>
+#include <wex/listview-sync.h>
+#include <wex/log.h>
+#include <wex/stat.h>
+#include <wx/evtloop.h>
+#include <wx/fswatcher.h>
+
+wex::listview_sync::listview_sync(listview* lv)
+  : m_listview(lv)
+{
+}
+
+wex::listview_sync::~listview_sync()
+{
+  if (m_watcher != nullptr)
+  {
+    m_listview->Unbind(wxEVT_FSWATCHER, &listview_sync::on_event, this);
+  }
+}
+
+bool wex::listview_sync::add(const std::string& dir)
+{
+  if (dir.empty() || m_dirs.contains(dir))
+  {
+    return true;
+  }
+
+  if (m_watcher == nullptr)
+  {
+    // The watcher can only be used from a running event loop,
+    // otherwise the folders are added when items change next time.
+    if (wxEventLoopBase::GetActive() == nullptr)
+    {
+      return false;
+    }
+
+    m_watcher = std::make_unique<wxFileSystemWatcher>();
+    m_watcher->SetOwner(m_listview);
+
+    m_listview->Bind(wxEVT_FSWATCHER, &listview_sync::on_event, this);
+  }
+
+  if (!m_watcher->Add(wxFileName::DirName(dir), wxFSW_EVENT_ALL))
+  {
+    log("listview sync") << dir;
+    return false;
+  }
+
+  m_dirs.insert(dir);
+
+  return true;
+}
+
+void wex::listview_sync::changed()
+{
+  if (m_pending)
+  {
+    return;
+  }
+
+  m_pending = true;
+
+  m_listview->CallAfter(
+    [=, this]
+    {
+      m_pending = false;
+      rebuild();
+    });
+}
+
+void wex::listview_sync::on_event(wxFileSystemWatcherEvent& event)
+{
+  event.Skip();
+
+  if (
+    event.GetChangeType() == wxFSW_EVENT_WARNING ||
+    event.GetChangeType() == wxFSW_EVENT_ERROR ||
+    !config("AllowSync").get(true))
+  {
+    return;
+  }
+
+  sync(event.GetPath().GetFullPath().ToStdString());
+
+  if (event.GetChangeType() == wxFSW_EVENT_RENAME)
+  {
+    sync(event.GetNewPath().GetFullPath().ToStdString());
+  }
+
+  if (m_updated)
+  {
+    m_updated = false;
+
+    if (
+      m_listview->data().type() == data::listview::FILE &&
+      config("list.SortSync").get(true) &&
+      m_listview->sorted_column_no() == m_listview->find_column(_("Modified")))
+    {
+      m_listview->sort_column(_("Modified"), SORT_KEEP);
+    }
+  }
+}
+
+void wex::listview_sync::rebuild()
+{
+  std::unordered_map<std::string, entry> entries;
+  std::set<std::string>                  dirs;
+
+  for (long i = 0; i < m_listview->GetItemCount(); i++)
+  {
+    const auto file(listitem(m_listview, i).file());
+    auto&      e = entries[file];
+
+    if (e.items.empty())
+    {
+      // keep the last known stat
+      if (const auto& it = m_entries.find(file); it != m_entries.end())
+      {
+        e.mtime    = it->second.mtime;
+        e.readonly = it->second.readonly;
+      }
+
+      dirs.insert(std::filesystem::path(file).parent_path().string());
+    }
+
+    e.items.emplace_back(i);
+  }
+
+  m_entries.swap(entries);
+
+  for (const auto& it : m_files)
+  {
+    dirs.insert(path(it.first).parent_path());
+  }
+
+  // Folders without items or watched files are no longer watched.
+  for (auto it = m_dirs.begin(); it != m_dirs.end();)
+  {
+    if (!dirs.contains(*it))
+    {
+      m_watcher->Remove(wxFileName::DirName(*it));
+      it = m_dirs.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  for (const auto& dir : dirs)
+  {
+    add(dir);
+  }
+}
+
+void wex::listview_sync::sync(const std::string& file)
+{
+  if (const auto& it = m_files.find(file); it != m_files.end())
+  {
+    // the callback might watch the file again
+    const auto f(it->second);
+    f();
+  }
+
+  auto it = m_entries.find(file);
+
+  if (it == m_entries.end())
+  {
+    return;
+  }
+
+  // Items might have been moved by sorting or deleting.
+  if (const auto& items(it->second.items); std::any_of(
+        items.begin(),
+        items.end(),
+        [this, &file](long item)
+        {
+          return item >= m_listview->GetItemCount() ||
+                 listitem(m_listview, item).file() != file;
+        }))
+  {
+    rebuild();
+
+    if ((it = m_entries.find(file)) == m_entries.end())
+    {
+      return;
+    }
+  }
+
+  // Compare the raw stat, a notification might not change it.
+  if (const file_stat stat(file);
+      stat.is_ok() && stat.st_mtime == it->second.mtime &&
+      stat.is_readonly() == it->second.readonly)
+  {
+    return;
+  }
+  else
+  {
+    it->second.mtime    = stat.is_ok() ? stat.st_mtime : 0;
+    it->second.readonly = stat.is_ok() && stat.is_readonly();
+  }
+
+  for (const auto item : it->second.items)
+  {
+    listitem(m_listview, item).update();
+  }
+
+  log::status() << path(file);
+
+  m_updated = true;
+}
+
+void wex::listview_sync::watch(const path& p, std::function<void()> f)
+{
+  m_files[p.string()] = f;
+
+  add(p.parent_path());
+}
@@ -12,6 +12,10 @@
 #endif
 #include <boost/algorithm/string.hpp>
 #include <boost/tokenizer.hpp>
+#include <cstdlib>
+#include <numeric>
+#include <regex>
+#include <thread>
 #include <wex/bind.h>
 #include <wex/chrono.h>
 #include <wex/config.h>
@@ -20,12 +24,12 @@
 #include <wex/factory/stc.h>
 #include <wex/frame.h>
 #include <wex/frd.h>
-#include <wex/interruptible.h>
 #include <wex/item-dialog.h>
 #include <wex/item-vector.h>
 #include <wex/item.h>
 #include <wex/lexers.h>
 #include <wex/listitem.h>
+#include <wex/listview-sync.h>
 #include <wex/listview.h>
 #include <wex/log.h>
 #include <wex/menu.h>
@@ -37,6 +41,9 @@
 #include <wx/imaglist.h>
 #include <wx/numdlg.h> // for wxGetNumberFromUser
 
+#include "listview-filter.h"
+#include "listview-meta.h"
+
 namespace wex
 {
 // file_droptarget is already used
@@ -72,14 +79,122 @@ private:
   listview* m_listview;
 };
 
-template <typename T> int compare(T x, T y)
+// Sorts the range stable, a large range is split into parts
+// that are sorted in parallel, and then merged in parallel.
+template <typename It, typename C>
+void parallel_stable_sort(It first, It last, C comp)
 {
-  if (x > y)
-    return 1;
-  else if (x < y)
-    return -1;
+  const size_t n     = std::distance(first, last);
+  const size_t parts = std::min<size_t>(
+    std::max<size_t>(1, std::thread::hardware_concurrency()),
+    n / 10000 + 1);
+
+  if (parts == 1)
+  {
+    std::stable_sort(first, last, comp);
+    return;
+  }
+
+  std::vector<It> bounds;
+
+  for (size_t i = 0; i <= parts; i++)
+  {
+    bounds.emplace_back(first + n * i / parts);
+  }
+
+  for (size_t width = 0; width < parts; width = (width == 0 ? 1 : width * 2))
+  {
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < parts; i += (width == 0 ? 1 : 2 * width))
+    {
+      if (width == 0)
+      {
+        threads.emplace_back(
+          [&bounds, &comp, i]
+          {
+            std::stable_sort(bounds[i], bounds[i + 1], comp);
+          });
+      }
+      else if (i + width < parts)
+      {
+        // merging adjacent parts keeps the order of equal elements
+        threads.emplace_back(
+          [&bounds, &comp, i, width, parts]
+          {
+            std::inplace_merge(
+              bounds[i],
+              bounds[i + width],
+              bounds[std::min(i + 2 * width, parts)],
+              comp);
+          });
+      }
+    }
+
+    for (auto& t : threads)
+    {
+      t.join();
+    }
+  }
+}
+
+// Returns the order of count items. The key of each item is
+// decoded once from its text, empty or invalid keys are placed first.
+template <typename T, typename G, typename D>
+std::vector<size_t> sort_order(size_t count, G text, D decode, bool ascending)
+{
+  std::vector<T>    keys(count);
+  std::vector<char> valid(count);
+  std::string       prev;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    // subsequent items often have the same text (e.g. find results)
+    if (const auto& t(text(i)); i > 0 && t == prev)
+    {
+      keys[i]  = keys[i - 1];
+      valid[i] = valid[i - 1];
+    }
+    else
+    {
+      valid[i] = !t.empty() && decode(t, keys[i]);
+      prev     = t;
+    }
+  }
+
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+
+  const auto it = std::stable_partition(
+    order.begin(),
+    order.end(),
+    [&valid](size_t i)
+    {
+      return !valid[i];
+    });
+
+  if (ascending)
+  {
+    parallel_stable_sort(
+      it,
+      order.end(),
+      [&keys](size_t x, size_t y)
+      {
+        return keys[x] < keys[y];
+      });
+  }
   else
-    return 0;
+  {
+    parallel_stable_sort(
+      it,
+      order.end(),
+      [&keys](size_t x, size_t y)
+      {
+        return keys[y] < keys[x];
+      });
+  }
+
+  return order;
 }
 
 std::string ignore_case(const std::string& text)
@@ -94,6 +209,32 @@ std::string ignore_case(const std::string& text)
   return output;
 };
 
+// Returns true if text is valid for the column type,
+// throws if it is not a number for a number column.
+bool is_valid(const column& col, const std::string& text)
+{
+  switch (col.type())
+  {
+    case column::DATE:
+      if (const auto& [r, t] = chrono().get_time(text); !r)
+        return false;
+      break;
+
+    case column::FLOAT:
+      std::stof(text);
+      break;
+
+    case column::INT:
+      std::stoi(text);
+      break;
+
+    default:
+      break;
+  }
+
+  return true;
+}
+
 const std::vector<item> config_items()
 {
   return std::vector<item>(
@@ -134,6 +275,7 @@ wex::listview::listview(const data::listview& data)
             data.type() == data::listview::TSV ?
           data.image() :
           data::listview::IMAGE_FILE_ICON))
+  , m_sync(std::make_unique<listview_sync>(this))
   , m_frame(dynamic_cast<wex::frame*>(wxTheApp->GetTopWindow()))
 {
   Create(
@@ -141,8 +283,10 @@ wex::listview::listview(const data::listview& data)
     data.window().id(),
     data.window().pos(),
     data.window().size(),
-    data.window().style() == data::NUMBER_NOT_SET ? wxLC_REPORT :
-                                                    data.window().style(),
+    data.window().style() != data::NUMBER_NOT_SET ?
+      data.window().style() :
+      (data.type() == data::listview::FIND ? wxLC_REPORT | wxLC_VIRTUAL :
+                                             wxLC_REPORT),
     data.control().validator() != nullptr ? *data.control().validator() :
                                             wxDefaultValidator,
     data.window().name());
@@ -179,56 +323,39 @@ wex::listview::listview(const data::listview& data)
 
   m_frame->update_statusbar(this);
 
+  // A virtual listview might contain too many items to sync.
   if (
     m_data.type() != data::listview::NONE &&
-    m_data.type() != data::listview::TSV)
+    m_data.type() != data::listview::TSV && !is_virtual())
   {
-    Bind(
-      wxEVT_IDLE,
-      [=, this](wxIdleEvent& event)
-      {
-        event.Skip();
-        if (
-          !IsShown() || interruptible::is_running() || GetItemCount() == 0 ||
-          !config("AllowSync").get(true))
-        {
-          return;
-        }
-        if (m_item_number < GetItemCount())
-        {
-          if (listitem item(this, m_item_number);
-              item.path().file_exists() &&
-              (item.path().stat().get_modification_time() !=
-                 get_item_text(m_item_number, _("Modified")) ||
-               item.path().stat().is_readonly() != item.is_readonly()))
-          {
-            item.update();
-            log::status() << item.path();
-            m_item_updated = true;
-          }
-
-          m_item_number++;
-        }
-        else
+    for (const auto& e :
+         {wxEVT_LIST_INSERT_ITEM,
+          wxEVT_LIST_DELETE_ITEM,
+          wxEVT_LIST_DELETE_ALL_ITEMS})
+    {
+      Bind(
+        e,
+        [=, this](wxListEvent& event)
         {
-          m_item_number = 0;
+          event.Skip();
+          m_sync->changed();
+        });
+    }
 
-          if (m_item_updated)
-          {
-            if (m_data.type() == data::listview::FILE)
-            {
-              if (
-                config("list.SortSync").get(true) &&
-                sorted_column_no() == find_column(_("Modified")))
-              {
-                sort_column(_("Modified"), SORT_KEEP);
-              }
-            }
+    if (
+      m_data.type() == data::listview::FILE ||
+      m_data.type() == data::listview::HISTORY)
+    {
+      m_meta = std::make_unique<listview_meta>(this);
 
-            m_item_updated = false;
-          }
-        }
-      });
+      Bind(
+        wxEVT_LIST_DELETE_ITEM,
+        [=, this](wxListEvent& event)
+        {
+          event.Skip();
+          m_meta->changed();
+        });
+    }
   }
 
   Bind(
@@ -451,6 +578,8 @@ wex::listview::listview(const data::listview& data)
     });
 }
 
+wex::listview::~listview() = default;
+
 bool wex::listview::append_columns(const std::vector<column>& cols)
 {
   SetSingleStyle(wxLC_REPORT);
@@ -469,6 +598,11 @@ bool wex::listview::append_columns(const std::vector<column>& cols)
     mycol.SetColumn(GetColumnCount() - 1);
     m_columns.emplace_back(mycol);
 
+    if (is_virtual())
+    {
+      m_store.append_column();
+    }
+
     Bind(
       wxEVT_MENU,
       [=, this](wxCommandEvent& event)
@@ -506,7 +640,7 @@ const std::string wex::listview::build_page()
 
     for (auto col = 0; col < GetColumnCount(); col++)
     {
-      text << "<td>" << GetItemText(i, col) << "\n";
+      text << "<td>" << cell_text(i, col) << "\n";
     }
   }
 
@@ -553,9 +687,31 @@ void wex::listview::build_popup_menu(wex::menu& menu)
   }
 }
 
+const std::string wex::listview::cell_text(long item_number, int col) const
+{
+  return is_virtual() ? std::string(m_store.get(store_row(item_number), col)) :
+                        GetItemText(item_number, col).ToStdString();
+}
+
 void wex::listview::clear()
 {
-  DeleteAllItems();
+  if (is_virtual())
+  {
+    m_filter.reset();
+    m_view.clear();
+    m_store.clear();
+    SetItemCount(0);
+    Refresh();
+  }
+  else
+  {
+    DeleteAllItems();
+  }
+
+  if (m_meta != nullptr)
+  {
+    m_meta->clear();
+  }
 
   sort_column_reset();
 
@@ -584,8 +740,15 @@ void wex::listview::config_get()
     [=, this](const std::string& back)
     {
       SetBackgroundColour(wxColour(back));
+    },
+    [=, this](const std::string& fore)
+    {
+      m_attr.SetTextColour(wxColour(fore));
     });
 
+  m_attr_readonly.SetTextColour(
+    config(_("list.Readonly colour")).get(*wxLIGHT_GREY));
+
   SetFont(iv.find<wxFont>(_("list.Font")));
   SetSingleStyle(
     wxLC_HRULES,
@@ -634,11 +797,48 @@ void wex::listview::edit_delete()
 
   long old_item = -1;
 
-  for (long i = -1; (i = GetNextSelected(i)) != -1;)
+  if (is_virtual())
   {
-    DeleteItem(i);
-    old_item = i;
-    i        = -1;
+    std::vector<size_t> rows;
+
+    for (auto i = GetFirstSelected(); i != -1; i = GetNextSelected(i))
+    {
+      rows.emplace_back(store_row(i));
+    }
+
+    old_item = GetFirstSelected();
+
+    SetItemState(-1, 0, wxLIST_STATE_SELECTED);
+    m_store.erase(rows);
+
+    if (m_filter != nullptr)
+    {
+      // The shown rows after an erased row move up.
+      std::vector<size_t> view;
+
+      for (const auto row : m_view)
+      {
+        if (const auto it = std::lower_bound(rows.begin(), rows.end(), row);
+            it == rows.end() || *it != row)
+        {
+          view.emplace_back(row - (it - rows.begin()));
+        }
+      }
+
+      m_view.swap(view);
+    }
+
+    SetItemCount(m_filter != nullptr ? m_view.size() : m_store.size());
+    Refresh();
+  }
+  else
+  {
+    for (long i = -1; (i = GetNextSelected(i)) != -1;)
+    {
+      DeleteItem(i);
+      old_item = i;
+      i        = -1;
+    }
   }
 
   if (old_item != -1 && old_item < GetItemCount())
@@ -647,6 +847,61 @@ void wex::listview::edit_delete()
   items_update();
 }
 
+bool wex::listview::filter(const std::string& text)
+{
+  if (!is_virtual())
+  {
+    return false;
+  }
+  else if (text.empty())
+  {
+    if (m_filter != nullptr)
+    {
+      m_filter.reset();
+      m_view.clear();
+      SetItemCount(m_store.size());
+      Refresh();
+    }
+
+    return true;
+  }
+
+  auto f(std::make_unique<listview_filter>(
+    m_columns,
+    text,
+    find_replace_data::get()->is_regex(),
+    find_replace_data::get()->match_case()));
+
+  if (!f->is_ok())
+  {
+    return false;
+  }
+
+  // When typing, the shown items are narrowed further.
+  std::vector<size_t> rows;
+
+  if (m_filter != nullptr && f->narrows(*m_filter))
+  {
+    rows.swap(m_view);
+  }
+  else
+  {
+    rows.resize(m_store.size());
+    std::iota(rows.begin(), rows.end(), 0);
+  }
+
+  m_view = f->match(m_store, rows);
+  m_filter.swap(f);
+
+  SetItemState(-1, 0, wxLIST_STATE_SELECTED);
+  SetItemCount(m_view.size());
+  Refresh();
+
+  m_frame->update_statusbar(this);
+
+  return true;
+}
+
 bool wex::listview::find_next(const std::string& text, bool forward)
 {
   if (text.empty())
@@ -654,7 +909,26 @@ bool wex::listview::find_next(const std::string& text, bool forward)
     return false;
   }
 
-  std::string text_use = ignore_case(text);
+  const auto* frd = find_replace_data::get();
+  std::regex  regex;
+
+  if (frd->is_regex())
+  {
+    try
+    {
+      regex = std::regex(
+        text,
+        frd->match_case() ? std::regex::ECMAScript :
+                            std::regex::ECMAScript | std::regex::icase);
+    }
+    catch (std::regex_error& e)
+    {
+      log(e) << text;
+      return false;
+    }
+  }
+
+  const std::string text_use = ignore_case(text);
 
   const auto  firstselected = GetFirstSelected();
   static bool recursive     = false;
@@ -673,30 +947,71 @@ bool wex::listview::find_next(const std::string& text, bool forward)
     end_item   = -1;
   }
 
-  int match = -1;
+  const auto is_match = [&](long index)
+  {
+    for (int col = 0; col < GetColumnCount(); col++)
+    {
+      if (frd->is_regex())
+      {
+        if (std::regex_search(cell_text(index, col), regex))
+        {
+          return true;
+        }
+      }
+      else if (const auto cell(ignore_case(cell_text(index, col)));
+               frd->match_word() ? cell == text_use :
+                                   cell.find(text_use) != std::string::npos)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  long match = -1;
 
-  for (int index = start_item; index != end_item && match == -1;
-       (forward ? index++ : index--))
+  // All cases scan the items, the store of a virtual list only
+  // avoids comparing the text of items that cannot match.
+  if (is_virtual() && !is_filtered() && !frd->is_regex())
+  {
+    match = m_store.find(
+      text,
+      start_item,
+      forward,
+      frd->match_case(),
+      frd->match_word());
+  }
+  else if (is_virtual() && !is_filtered())
   {
-    std::string text;
+    // Only the items containing the literal text of the regex are matched.
+    const auto literal(listview_filter::literal(text));
 
-    for (int col = 0; col < GetColumnCount() && match == -1; col++)
+    for (long index = start_item; index != end_item && match == -1;
+         (forward ? index++ : index--))
     {
-      text = ignore_case(std::string(GetItemText(index, col)));
+      if (
+        !literal.empty() &&
+        (index = m_store.find(literal, index, forward, frd->match_case())) ==
+          -1)
+      {
+        break;
+      }
 
-      if (find_replace_data::get()->match_word())
+      if (is_match(index))
       {
-        if (text == text_use)
-        {
-          match = index;
-        }
+        match = index;
       }
-      else
+    }
+  }
+  else
+  {
+    for (long index = start_item; index != end_item && match == -1;
+         (forward ? index++ : index--))
+    {
+      if (is_match(index))
       {
-        if (text.find(text_use) != std::string::npos)
-        {
-          match = index;
-        }
+        match = index;
       }
     }
   }
@@ -780,11 +1095,11 @@ const std::string wex::listview::get_item_text(
 
   if (col_name.empty())
   {
-    return GetItemText(item_number);
+    return cell_text(item_number, 0);
   }
 
   const int col = find_column(col_name);
-  return col < 0 ? std::string() : GetItemText(item_number, col).ToStdString();
+  return col < 0 ? std::string() : cell_text(item_number, col);
 }
 
 bool wex::listview::insert_item(
@@ -799,32 +1114,40 @@ bool wex::listview::insert_item(
   int  no    = 0;
   long index = 0;
 
-  for (const auto& col : item)
+  if (is_virtual())
   {
-    try
+    for (const auto& col : item)
     {
-      if (!col.empty())
+      try
       {
-        switch (m_columns[no].type())
+        if (!col.empty() && !is_valid(m_columns[no], col))
         {
-          case column::DATE:
-            if (const auto& [r, t] = chrono().get_time(col); !r)
-              return false;
-            break;
+          return false;
+        }
 
-          case column::FLOAT:
-            std::stof(col);
-            break;
+        no++;
+      }
+      catch (std::exception& e)
+      {
+        log(e) << "insert_item exception:" << col;
+        return false;
+      }
+    }
 
-          case column::INT:
-            std::stoi(col);
-            break;
+    store_insert(item, requested_index);
 
-          case column::STRING:
-            break;
+    return true;
+  }
 
-          default:
-            break;
+  for (const auto& col : item)
+  {
+    try
+    {
+      if (!col.empty())
+      {
+        if (!is_valid(m_columns[no], col))
+        {
+          return false;
         }
 
         if (no == 0)
@@ -972,7 +1295,7 @@ bool wex::listview::item_from_text(const std::string& text)
 
         if (!InReportView())
         {
-          listitem(this, path(it)).insert();
+          listitem(this, it).insert();
         }
         else
         {
@@ -1017,7 +1340,7 @@ bool wex::listview::item_from_text(const std::string& text)
           }
           else
           {
-            listitem(this, path(it)).insert();
+            listitem(this, it).insert();
           }
         }
     }
@@ -1036,7 +1359,7 @@ const std::string wex::listview::item_to_text(long item_number) const
   {
     for (auto i = 0; i < GetItemCount(); i++)
     {
-      text += GetItemText(i) + "\n";
+      text += cell_text(i, 0) + "\n";
     }
 
     return text;
@@ -1060,12 +1383,12 @@ const std::string wex::listview::item_to_text(long item_number) const
     break;
 
     case data::listview::FOLDER:
-      return GetItemText(item_number);
+      return cell_text(item_number, 0);
 
     default:
       for (int col = 0; col < GetColumnCount(); col++)
       {
-        text += GetItemText(item_number, col);
+        text += cell_text(item_number, col);
 
         if (col < GetColumnCount() - 1)
         {
@@ -1079,7 +1402,12 @@ const std::string wex::listview::item_to_text(long item_number) const
 
 void wex::listview::items_update()
 {
-  if (
+  if (is_virtual())
+  {
+    // the attributes are kept in the store
+    Refresh();
+  }
+  else if (
     m_data.type() != data::listview::NONE &&
     m_data.type() != data::listview::TSV)
   {
@@ -1121,6 +1449,22 @@ bool wex::listview::load(const std::list<std::string>& l)
   return true;
 }
 
+wxItemAttr* wex::listview::OnGetItemAttr(long item) const
+{
+  return m_store.get_data(store_row(item)) > 0 ? &m_attr_readonly : &m_attr;
+}
+
+int wex::listview::OnGetItemImage(long item) const
+{
+  return m_store.get_image(store_row(item));
+}
+
+wxString wex::listview::OnGetItemText(long item, long column) const
+{
+  const auto& text(m_store.get(store_row(item), column));
+  return wxString(text.data(), text.size());
+}
+
 bool wex::listview::on_command(wxCommandEvent& event)
 {
   switch (const long new_index =
@@ -1187,7 +1531,33 @@ void wex::listview::process_match(wxCommandEvent& event)
   const auto* m = static_cast<path_match*>(event.GetClientData());
   listitem    item(this, m->path());
 
-  item.insert();
+  // New items are not filtered.
+  filter(std::string());
+
+  if (const auto last = GetItemCount() - 1;
+      is_virtual() && last >= 0 &&
+      get_item_text(last, _("File Name")) == m->path().filename() &&
+      get_item_text(last, _("In Folder")) == m->path().parent_path())
+  {
+    // Another match in the same file, the file columns are copied
+    // (and share their text in the store), so the file is not accessed.
+    std::vector<std::string> cells;
+
+    for (size_t col = 0; col < m_store.columns(); col++)
+    {
+      cells.emplace_back(m_store.get(last, col));
+    }
+
+    const auto row = store_insert(cells, -1);
+    m_store.set_data(row, m_store.get_data(last));
+    m_store.set_image(row, m_store.get_image(last));
+    item.SetId(row);
+  }
+  else
+  {
+    item.insert();
+  }
+
   item.set_item(_("Line No"), std::to_string(m->line_no() + 1));
   item.set_item(_("Line"), context(m->line(), m->pos()));
   item.set_item(_("Match"), find_replace_data::get()->get_find_string());
@@ -1208,84 +1578,6 @@ const std::list<std::string> wex::listview::save() const
   return l;
 }
 
-std::vector<std::string>* pitems;
-
-int wxCALLBACK compare_cb(wxIntPtr item1, wxIntPtr item2, wxIntPtr sortData)
-{
-  const bool  ascending = (sortData > 0);
-  const auto& str1      = (*pitems)[item1];
-  const auto& str2      = (*pitems)[item2];
-
-  // should return 0 if the items are equal,
-  // negative value if the first item is less than the second one
-  // and positive value if the first one is greater than the second one
-
-  if (str1.empty() && str2.empty())
-  {
-    return 0;
-  }
-  else if (str1.empty())
-  {
-    return -1;
-  }
-  else if (str2.empty())
-  {
-    return 1;
-  }
-
-  switch (const auto type = (wex::column::type_t)std::abs(sortData); type)
-  {
-    case wex::column::DATE:
-    {
-      const auto& [r1, t1] = wex::chrono().get_time(str1);
-      const auto& [r2, t2] = wex::chrono().get_time(str2);
-      if (!r1 || !r2)
-        return 0;
-      if (ascending)
-        return wex::compare((unsigned long)t1, (unsigned long)t2);
-      else
-        return wex::compare((unsigned long)t2, (unsigned long)t1);
-    }
-    break;
-
-    case wex::column::FLOAT:
-      if (ascending)
-        return wex::compare(std::stof(str1), std::stof(str2));
-      else
-        return wex::compare(std::stof(str2), std::stof(str1));
-      break;
-
-    case wex::column::INT:
-      if (ascending)
-        return wex::compare(std::stoi(str1), std::stoi(str2));
-      else
-        return wex::compare(std::stoi(str2), std::stoi(str1));
-      break;
-
-    case wex::column::STRING:
-      if (!wex::find_replace_data::get()->match_case())
-      {
-        if (ascending)
-          return wex::ignore_case(str1).compare(wex::ignore_case(str2));
-        else
-          return wex::ignore_case(str2).compare(wex::ignore_case(str1));
-      }
-      else
-      {
-        if (ascending)
-          return str1.compare(str2);
-        else
-          return str2.compare(str1);
-      }
-      break;
-
-    default:
-      assert(0);
-  }
-
-  return 0;
-}
-
 bool wex::listview::set_item(
   long               index,
   int                column,
@@ -1297,26 +1589,20 @@ bool wex::listview::set_item(
 
   try
   {
-    switch (m_columns[column].type())
+    if (!is_valid(m_columns[column], text))
     {
-      case column::DATE:
-        if (const auto& [r, t] = chrono().get_time(text); !r)
-          return false;
-        break;
-
-      case column::FLOAT:
-        std::stof(text);
-        break;
-
-      case column::INT:
-        std::stoi(text);
-        break;
+      return false;
+    }
 
-      case column::STRING:
-        break;
+    if (is_virtual())
+    {
+      if (!m_store.set(store_row(index), column, text))
+      {
+        return false;
+      }
 
-      default:
-        break;
+      RefreshItem(index);
+      return true;
     }
 
     return SetItem(index, column, text, imageId);
@@ -1335,10 +1621,28 @@ bool wex::listview::set_item_image(long item_number, const wxArtID& artid)
     return false;
   }
 
-  return (
-    m_data.image() == data::listview::IMAGE_ART ?
-      SetItemImage(item_number, get_art_id(artid)) :
-      false);
+  if (m_data.image() != data::listview::IMAGE_ART)
+  {
+    return false;
+  }
+
+  return set_item_image(item_number, get_art_id(artid));
+}
+
+bool wex::listview::set_item_image(long item_number, int iconid)
+{
+  if (m_data.image() == data::listview::IMAGE_NONE)
+  {
+    return false;
+  }
+  else if (is_virtual())
+  {
+    m_store.set_image(store_row(item_number), iconid);
+    RefreshItem(item_number);
+    return true;
+  }
+
+  return SetItemImage(item_number, iconid);
 }
 
 bool wex::listview::sort_column(int column_no, sort_t sort_method)
@@ -1356,22 +1660,85 @@ bool wex::listview::sort_column(int column_no, sort_t sort_method)
 
   sorted_col.set_is_sorted_ascending(sort_method);
 
-  std::vector<std::string> items;
-  pitems = &items;
-
-  for (int i = 0; i < GetItemCount(); i++)
+  const auto count     = GetItemCount();
+  const auto ascending = sorted_col.is_sorted_ascending();
+  const auto text      = [this, column_no](size_t i)
   {
-    items.emplace_back(GetItemText(i, column_no));
-    SetItemData(i, i);
-  }
-
-  const wxIntPtr sortdata =
-    (sorted_col.is_sorted_ascending() ? sorted_col.type() :
-                                        (0 - sorted_col.type()));
+    return cell_text(i, column_no);
+  };
 
   try
   {
-    SortItems(compare_cb, sortdata);
+    std::vector<size_t> order;
+
+    switch (sorted_col.type())
+    {
+      case column::DATE:
+      {
+        const chrono chr;
+
+        order = sort_order<time_t>(
+          count,
+          text,
+          [&chr](const std::string& t, time_t& key)
+          {
+            const auto& [r, tt] = chr.get_time(t);
+            key                 = tt;
+            return r;
+          },
+          ascending);
+      }
+      break;
+
+      case column::FLOAT:
+        order = sort_order<double>(
+          count,
+          text,
+          [](const std::string& t, double& key)
+          {
+            char* end;
+            key = std::strtod(t.c_str(), &end);
+            return end != t.c_str();
+          },
+          ascending);
+        break;
+
+      case column::INT:
+        order = sort_order<long long>(
+          count,
+          text,
+          [](const std::string& t, long long& key)
+          {
+            char* end;
+            key = std::strtoll(t.c_str(), &end, 10);
+            return end != t.c_str();
+          },
+          ascending);
+        break;
+
+      default:
+      {
+        const bool fold = !find_replace_data::get()->match_case();
+
+        order = sort_order<std::string>(
+          count,
+          text,
+          [fold](const std::string& t, std::string& key)
+          {
+            key = t;
+
+            if (fold)
+            {
+              boost::algorithm::to_upper(key);
+            }
+
+            return true;
+          },
+          ascending);
+      }
+    }
+
+    reorder(order);
 
     m_sorted_column_no = column_no;
 
@@ -1385,7 +1752,6 @@ bool wex::listview::sort_column(int column_no, sort_t sort_method)
 
     if (GetItemCount() > 0)
     {
-      items_update();
       after_sorting();
     }
 
@@ -1400,6 +1766,110 @@ bool wex::listview::sort_column(int column_no, sort_t sort_method)
   return true;
 }
 
+void wex::listview::reorder(const std::vector<size_t>& order)
+{
+  if (is_virtual())
+  {
+    if (m_filter != nullptr)
+    {
+      // The shown items are sorted within the rows they have in the store,
+      // so the order is kept after the filter is removed.
+      std::vector<size_t> rows(m_store.size());
+      std::iota(rows.begin(), rows.end(), 0);
+
+      for (size_t i = 0; i < order.size(); i++)
+      {
+        rows[m_view[i]] = m_view[order[i]];
+      }
+
+      m_store.reorder(rows);
+    }
+    else
+    {
+      m_store.reorder(order);
+    }
+
+    Refresh();
+    return;
+  }
+
+  // Take the text and attributes of all items, and set them in
+  // the new order, keeping item data (readonly state) and selection.
+  std::vector<wxListItem>            items(order.size());
+  std::vector<std::vector<wxString>> texts(order.size());
+
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    items[i].SetId(i);
+    items[i].SetMask(wxLIST_MASK_IMAGE | wxLIST_MASK_DATA | wxLIST_MASK_STATE);
+    items[i].SetStateMask(wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+    GetItem(items[i]);
+    items[i].SetTextColour(GetItemTextColour(i));
+
+    for (int col = 0; col < GetColumnCount(); col++)
+    {
+      texts[i].emplace_back(GetItemText(i, col));
+    }
+  }
+
+  Freeze();
+
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    auto& item(items[order[i]]);
+    item.SetId(i);
+    SetItem(item);
+    SetItemTextColour(i, item.GetTextColour());
+
+    for (int col = 0; col < GetColumnCount(); col++)
+    {
+      SetItem(i, col, texts[order[i]][col]);
+    }
+  }
+
+  Thaw();
+
+  if (m_meta != nullptr)
+  {
+    m_meta->changed();
+  }
+}
+
+long wex::listview::store_insert(
+  const std::vector<std::string>& item,
+  long                            index)
+{
+  // New items are not filtered.
+  filter(std::string());
+
+  const auto row = m_store.insert(item, index);
+
+  SetItemCount(m_store.size());
+
+  if (row + 1 < m_store.size())
+  {
+    RefreshItems(row, m_store.size() - 1);
+  }
+
+  return row;
+}
+
+size_t wex::listview::store_row(long item) const
+{
+  if (m_filter == nullptr)
+  {
+    return item;
+  }
+
+  return item >= 0 && item < static_cast<long>(m_view.size()) ? m_view[item] :
+                                                                 m_store.size();
+}
+
+void wex::listview::sync_watch(const path& p, std::function<void()> f)
+{
+  m_sync->watch(p, f);
+}
+
 void wex::listview::sort_column_reset()
 {
   // only if we are using images
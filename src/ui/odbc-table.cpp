@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      odbc-table.cpp
+// Purpose:   Implementation of wex::odbc_table class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <limits>
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <wex/log.h>
+
+#if wexUSE_ODBC
+
+#include "odbc-table.h"
+
+wex::odbc_table::odbc_table(
+  const std::vector<std::string>& cols,
+  size_t                          cache_size)
+  : m_cols(cols)
+  , m_cache_size(cache_size)
+{
+}
+
+wex::odbc_table::~odbc_table() = default;
+
+void wex::odbc_table::add(const std::string_view& value)
+{
+  if (m_cols.empty())
+  {
+    return;
+  }
+
+  if (m_pages.empty() || m_pages.back().cells == page_rows * m_cols.size())
+  {
+    if (!m_pages.empty())
+    {
+      finish(m_pages.size() - 1);
+    }
+
+    m_pages.emplace_back();
+  }
+
+  auto& p = m_pages.back();
+
+  p.data.append(value);
+  p.ends.emplace_back(p.data.size());
+  p.cells++;
+
+  m_cells++;
+}
+
+std::string_view wex::odbc_table::cell(int row, int col)
+{
+  const auto  page_cells = page_rows * m_cols.size();
+  const auto  i          = row * m_cols.size() + col;
+  const auto  c          = i % page_cells;
+  const auto& p          = load(i / page_cells);
+  const auto  begin      = (c == 0 ? 0 : p.ends[c - 1]);
+
+  return std::string_view(p.data.data() + begin, p.ends[c] - begin);
+}
+
+void wex::odbc_table::evict(size_t keep)
+{
+  while (m_memory > m_cache_size)
+  {
+    page* lru = nullptr;
+
+    for (size_t i = 0; i < m_pages.size(); i++)
+    {
+      if (auto& p = m_pages[i];
+          i != keep && p.done && p.resident &&
+          (lru == nullptr || p.used < lru->used))
+      {
+        lru = &p;
+      }
+    }
+
+    if (lru == nullptr)
+    {
+      return;
+    }
+
+    // A page does not change, so it is written once.
+    if (lru->pos == -1)
+    {
+      if (m_temp == nullptr)
+      {
+        m_temp = std::make_unique<temp_filename>(true);
+        m_file.open(
+          m_temp->name(),
+          std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+      }
+
+      m_file.clear();
+      m_file.seekp(0, std::ios::end);
+      lru->pos = m_file.tellp();
+
+      m_file.write(
+        reinterpret_cast<const char*>(lru->ends.data()),
+        lru->ends.size() * sizeof(uint32_t));
+      m_file.write(lru->data.data(), lru->data.size());
+
+      if (!m_file)
+      {
+        // keep all pages in memory
+        log("odbc table write") << m_temp->name();
+        lru->pos = -1;
+        m_cache_size = std::numeric_limits<size_t>::max();
+        return;
+      }
+    }
+
+    m_memory -= size(*lru);
+
+    std::string().swap(lru->data);
+    std::vector<uint32_t>().swap(lru->ends);
+    lru->resident = false;
+  }
+}
+
+void wex::odbc_table::finish(size_t no)
+{
+  auto& p = m_pages[no];
+
+  p.data.shrink_to_fit();
+  p.ends.shrink_to_fit();
+  p.data_size = p.data.size();
+  p.done      = true;
+  p.used      = ++m_used;
+
+  m_memory += size(p);
+
+  evict(no);
+}
+
+wxString wex::odbc_table::GetColLabelValue(int col)
+{
+  return col >= 0 && col < GetNumberCols() ?
+           wxString(m_cols[col]) :
+           wxGridTableBase::GetColLabelValue(col);
+}
+
+wxString wex::odbc_table::GetValue(int row, int col)
+{
+  if (!m_edits.empty())
+  {
+    if (const auto& it = m_edits.find({row, col}); it != m_edits.end())
+    {
+      return it->second;
+    }
+  }
+
+  if (row < 0 || row >= GetNumberRows() || col < 0 || col >= GetNumberCols())
+  {
+    return wxEmptyString;
+  }
+
+  const auto value(cell(row, col));
+
+  return wxString(value.data(), value.size());
+}
+
+bool wex::odbc_table::IsEmptyCell(int row, int col)
+{
+  return GetValue(row, col).empty();
+}
+
+wex::odbc_table::page& wex::odbc_table::load(size_t no)
+{
+  auto& p = m_pages[no];
+
+  p.used = ++m_used;
+
+  if (!p.resident)
+  {
+    p.ends.resize(p.cells);
+    p.data.resize(p.data_size);
+
+    m_file.clear();
+    m_file.seekg(p.pos);
+    m_file.read(
+      reinterpret_cast<char*>(p.ends.data()),
+      p.ends.size() * sizeof(uint32_t));
+    m_file.read(p.data.data(), p.data.size());
+
+    if (!m_file)
+    {
+      log("odbc table read") << m_temp->name();
+    }
+
+    p.resident = true;
+    m_memory += size(p);
+
+    evict(no);
+  }
+
+  return p;
+}
+
+void wex::odbc_table::notify()
+{
+  if (const auto rows = (m_cols.empty() ? 0 : m_cells / m_cols.size());
+      rows > m_rows_shown)
+  {
+    const auto appended = rows - m_rows_shown;
+
+    m_rows_shown = rows;
+
+    if (GetView() != nullptr)
+    {
+      wxGridTableMessage msg(
+        this,
+        wxGRIDTABLE_NOTIFY_ROWS_APPENDED,
+        static_cast<int>(appended));
+      GetView()->ProcessTableMessage(msg);
+    }
+  }
+}
+
+void wex::odbc_table::SetValue(int row, int col, const wxString& value)
+{
+  m_edits[{row, col}] = value;
+}
+
+size_t wex::odbc_table::size(const page& p) const
+{
+  return p.data_size + p.cells * sizeof(uint32_t);
+}
+
+size_t wex::odbc_table::spilled() const
+{
+  return std::count_if(
+    m_pages.begin(),
+    m_pages.end(),
+    [](const auto& p)
+    {
+      return !p.resident;
+    });
+}
+#endif // wexUSE_ODBC
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      odbc-table.h
+// Purpose:   Declaration of wex::odbc_table class
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#if wexUSE_ODBC
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wex/temp-filename.h>
+#include <wx/grid.h>
+
+namespace wex
+{
+/// Offers a grid table for query results, keeping the rows in pages
+/// of cell values instead of a wxString for each cell.
+/// If the pages use more memory than the cache size, the least recently
+/// used pages are moved to a temp file, and read back when shown again.
+class odbc_table : public wxGridTableBase
+{
+public:
+  /// Number of rows in a page.
+  static constexpr size_t page_rows = 1024;
+
+  /// Constructor, specify the column labels and the cache size in bytes.
+  odbc_table(const std::vector<std::string>& cols, size_t cache_size);
+
+  /// Destructor.
+  ~odbc_table() override;
+
+  /// Adds a cell value to the row being fetched, after
+  /// a value for each column, the next row is started.
+  void add(const std::string_view& value);
+
+  /// Returns memory used by the pages not in the temp file.
+  auto memory() const { return m_memory; }
+
+  /// Notifies the grid about the rows added since last notify.
+  void notify();
+
+  /// Returns number of pages in the temp file.
+  size_t spilled() const;
+
+  // Interface from wxGridTableBase.
+  wxString GetColLabelValue(int col) override;
+  int      GetNumberCols() override { return m_cols.size(); }
+  int      GetNumberRows() override { return m_rows_shown; }
+  wxString GetValue(int row, int col) override;
+  bool     IsEmptyCell(int row, int col) override;
+  void     SetValue(int row, int col, const wxString& value) override;
+
+private:
+  // The cell values of a page, cell i ends at ends[i] in data.
+  struct page
+  {
+    std::string           data;
+    std::vector<uint32_t> ends;
+    std::streamoff        pos{-1}; // position in temp file, if written
+    size_t                data_size{0}, cells{0};
+    uint64_t              used{0};
+    bool                  done{false}, resident{true};
+  };
+
+  std::string_view cell(int row, int col);
+  void             evict(size_t keep);
+  void             finish(size_t no);
+  page&            load(size_t no);
+  size_t           size(const page& p) const;
+
+  const std::vector<std::string> m_cols;
+  size_t                         m_cache_size;
+
+  std::vector<page>                       m_pages;
+  std::map<std::pair<int, int>, wxString> m_edits;
+
+  std::unique_ptr<temp_filename> m_temp;
+  std::fstream                   m_file;
+
+  size_t   m_cells{0}, m_memory{0}, m_rows_shown{0};
+  uint64_t m_used{0};
+};
+}; // namespace wex
+#endif
@@ -5,12 +5,20 @@
 // Copyright: (c) 2008-2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
+#include <boost/algorithm/string/join.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <wx/wxprec.h>
 #ifndef WX_PRECOMP
 #include <wx/wx.h>
 #endif
 #include <wex/config.h>
 #include <wex/core.h>
+#include <wex/csv-writer.h>
 #include <wex/factory/stc.h>
 #include <wex/frame.h>
 #include <wex/item-dialog.h>
@@ -18,6 +26,8 @@
 #include <wex/odbc.h>
 #include <wx/grid.h>
 
+#include "odbc-table.h"
+
 #if wexUSE_ODBC
 
 #define OTL_CPP_20_ON
@@ -33,48 +43,463 @@
 
 namespace wex
 {
+std::string query_error(const otl_exception& e)
+{
+  const std::string query((const char*)e.stm_text);
+
+  if (const std::string str((const char*)e.msg); !str.empty())
+  {
+    return "OTL error: " + wex::quoted(str);
+  }
+  else if (const std::string ss((const char*)e.sqlstate); !ss.empty())
+  {
+    return "sqlstate: " + ss + " in: " + wex::quoted(query);
+  }
+  else
+  {
+    return "error, no more info";
+  }
+}
+
+void handle_error(const otl_exception& e, const otl_column_desc& desc)
+{
+  wex::log::trace() << query_error(e) << "skipped: (" << desc.otl_var_dbtype
+                    << "," << desc.dbsize << ")";
+}
+
+// Returns the table to put the results on, the rows are appended to the
+// table of previous results if it has the same columns, otherwise a
+// new table is used.
+odbc_table* grid_table(
+  wxGrid*                         grid,
+  const std::vector<std::string>& cols,
+  bool                            empty_results,
+  bool&                           is_new)
+{
+  auto* table = dynamic_cast<odbc_table*>(grid->GetTable());
+
+  is_new = empty_results || table == nullptr ||
+           table->GetNumberCols() != (int)cols.size();
+
+  if (!is_new)
+  {
+    return table;
+  }
+
+  table = new odbc_table(
+    cols,
+    config("odbc.Cache size").get(256L) * 1024 * 1024);
+
+  // Keep the rows already on the grid.
+  if (!empty_results && grid->GetTable() != nullptr)
+  {
+    for (auto row = 0; row < grid->GetNumberRows(); row++)
+    {
+      for (auto n = 0; n < (int)cols.size(); n++)
+      {
+        table->add(
+          n < grid->GetNumberCols() ?
+            grid->GetCellValue(row, n).ToStdString() :
+            std::string());
+      }
+    }
+
+    table->notify();
+  }
+
+  grid->SetTable(table, true);
+
+  return table;
+}
+
+// Reads the next cell value from the stream.
+std::string read(otl_stream& i, const otl_column_desc& desc)
+{
+  if (desc.otl_var_dbtype == otl_var_varchar_long)
+  {
+    otl_long_string var;
+    i >> var;
+    return std::string(reinterpret_cast<char*>(var.v), var.len());
+  }
+  else
+  {
+    std::string s;
+    i >> s;
+    return s;
+  }
+}
+
+// The state of an async query, shared by the odbc and its worker,
+// so the worker can be left behind if the odbc is destroyed
+// while the query is not yet fetching.
+class odbc_query
+{
+public:
+  std::mutex               mutex;
+  std::condition_variable  cv;
+  otl_stream*              stream{nullptr};
+  std::vector<std::string> cells, cols;
+  std::string              error;
+  std::atomic_bool         cancel{false};
+  bool                     done{false}, posted{false};
+
+  // The handler to post results to, reset when left behind.
+  wxEvtHandler*         handler{nullptr};
+  std::function<void()> apply;
+
+  // Invoke with the mutex locked.
+  void post()
+  {
+    if (!posted && handler != nullptr)
+    {
+      posted = true;
+      handler->CallAfter(apply);
+    }
+  }
+};
+
 class odbc_imp
 {
 public:
   odbc_imp(bool threaded_mode, size_t buffer_size)
     : m_buffer_size(buffer_size)
+    , m_threaded_mode(threaded_mode)
   {
     otl_connect::otl_initialize(threaded_mode);
   };
 
+  ~odbc_imp();
+
   auto buffer_size() const { return m_buffer_size; }
 
+  bool cancel();
+
   auto& connect() { return m_connect; }
 
+  auto& connect_string() { return m_connect_string; }
+
+  bool is_running() const { return m_thread.joinable(); }
+
+  auto rows() const { return m_rows; }
+
+  bool start(
+    const std::string& query,
+    wxGrid*            grid,
+    bool               empty_results,
+    wxStyledTextCtrl*  stc);
+
 private:
+  void apply();
+
+  static void run(
+    const std::shared_ptr<odbc_query>& q,
+    const std::string&                 connect,
+    const std::string&                 query,
+    size_t                             buffer_size,
+    const std::string&                 skipped);
+
   otl_connect  m_connect;
+  std::string  m_connect_string;
   const size_t m_buffer_size;
+  const bool   m_threaded_mode;
+
+  // The async query, the worker fetches the cells,
+  // and they are shown from the event loop.
+  wxEvtHandler                m_handler;
+  std::thread                 m_thread;
+  std::shared_ptr<odbc_query> m_q;
+  std::string                 m_query;
+
+  // The target of the async query, only used from the event loop.
+  wxGrid*           m_grid{nullptr};
+  wxStyledTextCtrl* m_stc{nullptr};
+  odbc_table*       m_table{nullptr};
+  size_t            m_col_count{0};
+  long              m_rows{0};
+  bool              m_empty_results{true}, m_is_new{false};
 };
+}; // namespace wex
 
-std::string query_error(const otl_exception& e)
+wex::odbc_imp::~odbc_imp()
 {
-  const std::string query((const char*)e.stm_text);
+  if (!cancel())
+  {
+    return;
+  }
+
+  bool fetching;
 
-  if (const std::string str((const char*)e.msg); !str.empty())
   {
-    return "OTL error: " + wex::quoted(str);
+    std::lock_guard<std::mutex> lock(m_q->mutex);
+    m_q->handler = nullptr;
+    fetching     = m_q->stream != nullptr || m_q->done;
   }
-  else if (const std::string ss((const char*)e.sqlstate); !ss.empty())
+
+  // A fetching statement is cancelled, and the worker returns soon.
+  // Logging on or executing the statement cannot be cancelled,
+  // so the worker is left behind, it stops as soon as it returns.
+  if (fetching)
   {
-    return "sqlstate: " + ss + " in: " + wex::quoted(query);
+    m_thread.join();
   }
   else
   {
-    return "error, no more info";
+    log::trace("query async left behind") << m_query;
+    m_thread.detach();
   }
 }
 
-void handle_error(const otl_exception& e, const otl_column_desc& desc)
+void wex::odbc_imp::apply()
 {
-  wex::log::trace() << query_error(e) << "skipped: (" << desc.otl_var_dbtype
-                    << "," << desc.dbsize << ")";
+  std::vector<std::string> cells;
+  bool                     done;
+
+  {
+    std::lock_guard<std::mutex> lock(m_q->mutex);
+
+    cells.swap(m_q->cells);
+    done        = m_q->done;
+    m_q->posted = false;
+
+    if (m_col_count == 0 && !m_q->cols.empty())
+    {
+      m_col_count = m_q->cols.size();
+
+      if (m_grid != nullptr)
+      {
+        m_table = grid_table(m_grid, m_q->cols, m_empty_results, m_is_new);
+      }
+      else
+      {
+        m_stc->NewLine();
+        m_stc->AppendText(boost::algorithm::join(m_q->cols, "\t"));
+        m_stc->NewLine();
+      }
+    }
+  }
+
+  // The worker might wait for the cells to be taken.
+  m_q->cv.notify_all();
+
+  if (m_col_count > 0 && !cells.empty())
+  {
+    if (m_table != nullptr)
+    {
+      for (const auto& cell : cells)
+      {
+        m_table->add(cell);
+      }
+
+      m_table->notify();
+
+      if (m_is_new && m_rows < 0x100)
+      {
+        m_grid->AutoSizeColumns(false); // not set as minimum width
+      }
+    }
+    else if (m_stc != nullptr)
+    {
+      const auto*       stc = dynamic_cast<factory::stc*>(m_stc);
+      const std::string eol(stc != nullptr ? stc->eol() : "\n");
+      std::string       text;
+
+      for (size_t i = 0; i < cells.size(); i++)
+      {
+        text += cells[i];
+        text += ((i + 1) % m_col_count == 0 ? eol : "\t");
+      }
+
+      m_stc->AppendText(text);
+    }
+
+    m_rows += cells.size() / m_col_count;
+
+    log::status(_("Rows").ToStdString()) << m_rows;
+  }
+
+  if (done)
+  {
+    m_thread.join();
+
+    if (!m_q->error.empty())
+    {
+      log("query") << m_q->error;
+      m_rows = -1;
+    }
+
+    log::trace("query async") << m_query << "records:" << m_rows;
+  }
+}
+
+bool wex::odbc_imp::cancel()
+{
+  if (!is_running())
+  {
+    return false;
+  }
+
+  m_q->cancel = true;
+
+  std::lock_guard<std::mutex> lock(m_q->mutex);
+
+  m_q->cv.notify_all();
+
+  // The stream is open, so the statement can be cancelled, otherwise
+  // the worker stops after opening it.
+  if (m_q->stream != nullptr)
+  {
+    try
+    {
+      m_q->stream->cancel();
+    }
+    catch (otl_exception& e)
+    {
+      log("query cancel") << query_error(e);
+    }
+  }
+
+  return true;
+}
+
+void wex::odbc_imp::run(
+  const std::shared_ptr<odbc_query>& q,
+  const std::string&                 connect,
+  const std::string&                 query,
+  size_t                             buffer_size,
+  const std::string&                 skipped)
+{
+  // Keep memory constant, the worker waits if the cells are not
+  // taken fast enough.
+  const size_t max_cells = 64 * 1024;
+
+  otl_connect db;
+  otl_stream  i;
+  std::string error;
+
+  try
+  {
+    db.rlogon(connect.c_str(), 1); // autocommit-flag
+
+    i.set_all_column_types(otl_all_num2str | otl_all_date2str);
+    i.open(buffer_size, query.c_str(), db, otl_implicit_select);
+
+    {
+      std::lock_guard<std::mutex> lock(q->mutex);
+      q->stream = &i;
+    }
+
+    int         desc_len;
+    const auto* desc = i.describe_select(desc_len);
+
+    {
+      std::lock_guard<std::mutex> lock(q->mutex);
+
+      for (auto n = 0; n < desc_len; n++)
+      {
+        q->cols.emplace_back(desc[n].name);
+      }
+
+      q->post();
+    }
+
+    std::vector<std::string> row;
+
+    while (!q->cancel && !i.eof())
+    {
+      row.clear();
+
+      for (auto n = 0; n < desc_len && !q->cancel; n++)
+      {
+        try
+        {
+          row.emplace_back(read(i, desc[n]));
+        }
+        catch (otl_exception& e)
+        {
+          row.emplace_back(skipped);
+          handle_error(e, desc[n]);
+        }
+      }
+
+      std::unique_lock<std::mutex> lock(q->mutex);
+
+      q->cv.wait(
+        lock,
+        [&q]
+        {
+          return q->cells.size() < max_cells || q->cancel;
+        });
+
+      if (!q->cancel)
+      {
+        std::move(row.begin(), row.end(), std::back_inserter(q->cells));
+        q->post();
+      }
+    }
+  }
+  catch (otl_exception& e)
+  {
+    if (!q->cancel)
+    {
+      error = query_error(e);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(q->mutex);
+
+  q->stream = nullptr;
+  q->error  = error;
+  q->done   = true;
+
+  q->post();
+}
+
+bool wex::odbc_imp::start(
+  const std::string& query,
+  wxGrid*            grid,
+  bool               empty_results,
+  wxStyledTextCtrl*  stc)
+{
+  if (!m_threaded_mode)
+  {
+    log("query async requires threaded mode") << query;
+    return false;
+  }
+
+  if (is_running())
+  {
+    return false;
+  }
+
+  m_grid          = grid;
+  m_stc           = stc;
+  m_table         = nullptr;
+  m_col_count     = 0;
+  m_rows          = 0;
+  m_empty_results = empty_results;
+  m_is_new        = false;
+  m_query         = query;
+
+  m_q          = std::make_shared<odbc_query>();
+  m_q->handler = &m_handler;
+  m_q->apply   = [this]
+  {
+    apply();
+  };
+
+  m_thread = std::thread(
+    [q       = m_q,
+     connect = m_connect_string,
+     query,
+     buffer_size = m_buffer_size,
+     skipped =
+       (grid != nullptr ? _("<Skipped>").ToStdString() : std::string())]
+    {
+      run(q, connect, query, buffer_size, skipped);
+    });
+
+  return true;
 }
-}; // namespace wex
 
 wex::odbc::odbc(bool threaded_mode, size_t buffer_size)
   : m_odbc(std::make_unique<odbc_imp>(threaded_mode, buffer_size))
@@ -147,6 +572,7 @@ bool wex::odbc::logon(const wex::data::window& par)
 
     m_odbc->connect().rlogon(connect.c_str(),
                              1); // autocommit-flag
+    m_odbc->connect_string() = connect;
   }
   catch (otl_exception& p)
   {
@@ -204,7 +630,6 @@ long wex::odbc::query(
     m_odbc->connect(),
     otl_implicit_select);
 
-  long             rows = 0;
   otl_column_desc* desc;
 
   // Get column names.
@@ -220,69 +645,54 @@ long wex::odbc::query(
     return -1;
   }
 
-  if (empty_results)
-  {
-    if (grid->GetNumberCols() > 0)
-    {
-      grid->DeleteCols(0, grid->GetNumberCols());
-    }
-
-    grid->AppendCols(desc_len);
+  std::vector<std::string> cols;
 
-    for (auto n = 0; n < desc_len; n++)
-    {
-      grid->SetColLabelValue(n, desc[n].name);
-    }
-
-    if (grid->GetNumberRows() > 0)
-    {
-      grid->DeleteRows(0, grid->GetNumberRows());
-    }
+  for (auto n = 0; n < desc_len; n++)
+  {
+    cols.emplace_back(desc[n].name);
   }
 
-  grid->BeginBatch();
+  bool  is_new;
+  auto* table = grid_table(grid, cols, empty_results, is_new);
 
-  const auto startrow = grid->GetNumberRows();
+  long rows = 0;
 
-  // Get all rows.
+  // Get all rows, the first rows are shown as soon as they are fetched,
+  // and then the grid is updated after each batch of rows.
   while (!i.eof() && !stopped)
   {
-    grid->AppendRows();
-
     for (auto n = 0; n < desc_len; n++)
     {
       try
       {
-        if (desc[n].otl_var_dbtype == otl_var_varchar_long)
-        {
-          otl_long_string var;
-          i >> var;
-          grid->SetCellValue(startrow + rows, n, var.v);
-        }
-        else
-        {
-          std::string s;
-          i >> s;
-          grid->SetCellValue(startrow + rows, n, s);
-        }
+        table->add(read(i, desc[n]));
       }
       catch (otl_exception& e)
       {
-        grid->SetCellValue(startrow + rows, n, _("<Skipped>"));
+        table->add(_("<Skipped>").ToStdString());
         handle_error(e, desc[n]);
       }
     }
 
-    if ((rows & 0xff) == 0)
+    if ((++rows & 0xff) == 0)
     {
+      table->notify();
+
+      if (rows == 0x100 && is_new)
+      {
+        grid->AutoSizeColumns(false); // not set as minimum width
+      }
+
       wxTheApp->Yield();
     }
-
-    rows++;
   }
 
-  grid->EndBatch();
-  grid->AutoSizeColumns(false); // not set as minimum width
+  table->notify();
+
+  if (rows < 0x100 && is_new)
+  {
+    grid->AutoSizeColumns(false);
+  }
 
   log::trace("query grid") << query << "records:" << rows;
 
@@ -346,18 +756,7 @@ long wex::odbc::query(
     {
       try
       {
-        if (desc[n].otl_var_dbtype == otl_var_varchar_long)
-        {
-          otl_long_string var;
-          i >> var;
-          line += var.v;
-        }
-        else
-        {
-          std::string s;
-          i >> s;
-          line += s;
-        }
+        line += read(i, desc[n]);
       }
       catch (otl_exception& e)
       {
@@ -383,4 +782,130 @@ long wex::odbc::query(
 
   return rows;
 }
+long wex::odbc::query(
+  const std::string& query,
+  const path&        p,
+  bool&              stopped,
+  const data::csv&   data)
+{
+  if (!is_connected())
+  {
+    return 0;
+  }
+
+  otl_column_desc* desc;
+  otl_stream       i;
+  int              desc_len;
+
+  try
+  {
+    i.set_all_column_types(otl_all_num2str | otl_all_date2str);
+    i.open(
+      m_odbc->buffer_size(),
+      query.c_str(),
+      m_odbc->connect(),
+      otl_implicit_select);
+
+    desc = i.describe_select(desc_len);
+  }
+  catch (otl_exception& e)
+  {
+    log("query") << query_error(e);
+    return -1;
+  }
+
+  csv_writer out(p, data);
+
+  std::vector<std::string> cols;
+
+  for (auto n = 0; n < desc_len; n++)
+  {
+    cols.emplace_back(desc[n].name);
+  }
+
+  out.header(cols);
+
+  const auto start = std::chrono::steady_clock::now();
+  auto       shown = start;
+  long       rows  = 0;
+
+  // Get all rows, each row is written to the buffer of the writer.
+  while (!i.eof() && !stopped && out.is_ok())
+  {
+    for (auto n = 0; n < desc_len; n++)
+    {
+      try
+      {
+        out.add(read(i, desc[n]));
+      }
+      catch (otl_exception& e)
+      {
+        out.add(std::string());
+        handle_error(e, desc[n]);
+      }
+    }
+
+    out.end_row();
+
+    if ((++rows & 0xfff) == 0)
+    {
+      if (const auto now = std::chrono::steady_clock::now();
+          now - shown >= std::chrono::seconds(1))
+      {
+        const auto ms =
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - start)
+            .count();
+
+        shown = now;
+        log::status(_("Rows").ToStdString())
+          << rows << "rows/s:" << rows * 1000 / ms;
+      }
+
+      wxTheApp->Yield();
+    }
+  }
+
+  if (!out.close())
+  {
+    log("query write") << p;
+    return -1;
+  }
+
+  log::trace("query csv") << query << "records:" << rows
+                          << "bytes:" << out.bytes();
+
+  return rows;
+}
+
+bool wex::odbc::query_async(
+  const std::string& query,
+  wxGrid*            grid,
+  bool               empty_results)
+{
+  assert(grid != nullptr);
+
+  return is_connected() && m_odbc->start(query, grid, empty_results, nullptr);
+}
+
+bool wex::odbc::query_async(const std::string& query, wxStyledTextCtrl* stc)
+{
+  assert(stc != nullptr);
+
+  return is_connected() && m_odbc->start(query, nullptr, false, stc);
+}
+
+bool wex::odbc::query_cancel()
+{
+  return m_odbc->cancel();
+}
+
+long wex::odbc::query_rows() const
+{
+  return m_odbc->rows();
+}
+
+bool wex::odbc::query_running() const
+{
+  return m_odbc->is_running();
+}
 #endif // wexUSE_ODBC
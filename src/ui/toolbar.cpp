@@ -39,8 +39,16 @@ public:
   /// from find_replace_data.
   find_textctrl(wex::frame* frame, const data::window& data);
 
+  /// Filters the listview using current value in control, if
+  /// filtering is checked, otherwise removes the filter.
+  /// Returns false if there is no virtual listview to filter.
+  bool filter();
+
   /// Finds current value in control.
   void find(bool find_next = true, bool restore_position = false);
+
+private:
+  listview* get_listview();
 };
 
 void find_popup_menu(
@@ -214,6 +222,17 @@ void wex::toolbar::add_find(bool realize)
       [](wxCheckBox* cb)
       {
         find_replace_data::get()->set_regex(cb->GetValue());
+      }},
+     {NewControlId(),
+      _("Filter"),
+      "",
+      "FindFilter",
+      _("Filter list items while typing"),
+      false,
+      [=](wxCheckBox* cb)
+      {
+        config("FindFilter").set(cb->GetValue());
+        findCtrl->filter();
       }}},
     false);
 
@@ -391,7 +410,11 @@ wex::find_textctrl::find_textctrl(wex::frame* mng, const data::window& data)
     [=, this](wxCommandEvent& event)
     {
       event.Skip();
-      find(true, true);
+
+      if (!config("FindFilter").get(false) || !filter())
+      {
+        find(true, true);
+      }
     });
 
   control()->Bind(
@@ -407,6 +430,27 @@ wex::find_textctrl::find_textctrl(wex::frame* mng, const data::window& data)
     });
 }
 
+bool wex::find_textctrl::filter()
+{
+  if (get_listview() == nullptr)
+  {
+    return false;
+  }
+
+  // The filter is set after pending events, so a filter for text
+  // that is changed again by typing is skipped.
+  control()->CallAfter(
+    [=, this, text = get_text()]
+    {
+      if (auto* lv = get_listview(); lv != nullptr && text == get_text())
+      {
+        lv->filter(config("FindFilter").get(false) ? text : std::string());
+      }
+    });
+
+  return true;
+}
+
 void wex::find_textctrl::find(bool find_next, bool restore_position)
 {
   if (auto* stc = get_frame()->get_stc(); stc != nullptr)
@@ -428,3 +472,17 @@ void wex::find_textctrl::find(bool find_next, bool restore_position)
     lv->find_next(get_text(), find_next);
   }
 }
+
+wex::listview* wex::find_textctrl::get_listview()
+{
+  if (
+    get_frame()->get_stc() != nullptr ||
+    dynamic_cast<wex::grid*>(get_frame()->get_grid()) != nullptr)
+  {
+    return nullptr;
+  }
+
+  auto* lv = dynamic_cast<wex::listview*>(get_frame()->get_listview());
+
+  return lv != nullptr && lv->is_virtual() ? lv : nullptr;
+}
@@ -15,6 +15,7 @@
 #include <wex/core.h>
 #include <wex/ex-stream.h>
 #include <wex/ex.h>
+#include <wex/factory/filter.h>
 #include <wex/factory/process.h>
 #include <wex/factory/stc.h>
 #include <wex/file.h>
@@ -23,7 +24,9 @@
 #include <wex/log.h>
 #include <wex/macros.h>
 #include <wex/regex.h>
+#include <wex/register-file.h>
 #include <wex/sort.h>
+#include <wex/substitute-engine.h>
 #include <wex/temp-filename.h>
 #include <wex/util.h>
 
@@ -341,6 +344,11 @@ bool wex::addressrange::escape(const std::string& command)
     return false;
   }
 
+  if (m_stc->is_visual())
+  {
+    return escape_filter(command);
+  }
+
   if (temp_filename tmp(true);
       m_stc->GetReadOnly() || m_stc->is_hexmode() || !write(tmp.name()))
   {
@@ -372,6 +380,48 @@ bool wex::addressrange::escape(const std::string& command)
   return false;
 }
 
+bool wex::addressrange::escape_filter(const std::string& command) const
+{
+  if (m_stc->GetReadOnly() || m_stc->is_hexmode() || !set_selection())
+  {
+    return false;
+  }
+
+  // The range is piped to the command, no temp files are used.
+  const auto&     input(m_stc->get_selected_text());
+  factory::filter filter;
+
+  if (filter.system(command, input) != 0 || filter.get_stdout().empty())
+  {
+    if (!filter.get_stderr().empty())
+    {
+      m_ex->frame()->show_ex_message(filter.get_stderr());
+      log("escape") << filter.get_stderr();
+    }
+
+    return false;
+  }
+
+  const auto start = m_stc->GetSelectionStart();
+
+  // If the output is the same as the input, nothing is changed,
+  // otherwise the range is replaced as one undo action.
+  if (filter.get_stdout() != input)
+  {
+    m_stc->SetTargetRange(start, m_stc->GetSelectionEnd());
+    m_stc->ReplaceTargetRaw(
+      filter.get_stdout().data(),
+      filter.get_stdout().size());
+  }
+
+  m_stc->GotoPos(start);
+
+  m_begin.marker_delete();
+  m_end.marker_delete();
+
+  return true;
+}
+
 bool wex::addressrange::execute(const std::string& reg) const
 {
   if (!is_ok() || !ex::get_macros().is_recorded_macro(reg))
@@ -414,7 +464,17 @@ bool wex::addressrange::general(
   if (f())
   {
     m_stc->goto_line(dest_line - 1);
-    m_stc->add_text(m_ex->register_text());
+
+    if (const auto& rf(m_ex->get_macros().get_register_file(
+          m_ex->register_name() ? m_ex->register_name() : '0'));
+        rf != nullptr)
+    {
+      m_stc->AddTextRaw(rf->data(), rf->size());
+    }
+    else
+    {
+      m_stc->add_text(m_ex->register_text());
+    }
   }
 
   m_stc->EndUndoAction();
@@ -845,6 +905,11 @@ bool wex::addressrange::substitute(const std::string& text, char cmd)
     return m_ex->ex_stream()->substitute(*this, data);
   }
 
+  if (!data.is_confirmed() && !m_stc->is_hexmode())
+  {
+    return substitute_single_pass(data, searchFlags);
+  }
+
   if (!m_ex->marker_add('#', m_begin.get_line() - 1))
   {
     log::debug("substitute could not add marker");
@@ -951,6 +1016,74 @@ bool wex::addressrange::substitute(const std::string& text, char cmd)
   return true;
 }
 
+bool wex::addressrange::substitute_single_pass(
+  const data::substitute& data,
+  int                     search_flags)
+{
+  auto begin_line = m_begin.get_line() - 1;
+  auto end_line   = m_end.get_line() - 1;
+  int  corrected  = 0;
+
+  if (!m_stc->GetSelectedText().empty())
+  {
+    if (
+      m_stc->GetLineSelEndPosition(end_line) ==
+      m_stc->PositionFromLine(end_line))
+    {
+      end_line--;
+      corrected = 1;
+    }
+  }
+
+  substitute_engine::substitute_t flags;
+  flags.set(substitute_engine::SUBSTITUTE_GLOBAL, data.is_global());
+  flags.set(
+    substitute_engine::SUBSTITUTE_MATCH_CASE,
+    search_flags & wxSTC_FIND_MATCHCASE);
+  flags.set(
+    substitute_engine::SUBSTITUTE_MATCH_WORD,
+    search_flags & wxSTC_FIND_WHOLEWORD);
+  flags.set(
+    substitute_engine::SUBSTITUTE_REGEX,
+    search_flags & wxSTC_FIND_REGEXP);
+  flags.set(
+    substitute_engine::SUBSTITUTE_VI,
+    data.replacement().find_first_of("&0LU\\") != std::string::npos);
+
+  const auto lines = m_stc->get_line_count();
+  const auto nr_replacements =
+    substitute_engine(data.pattern(), data.replacement(), flags)
+      .range(
+        m_stc,
+        m_stc->PositionFromLine(begin_line),
+        m_stc->GetLineEndPosition(end_line));
+
+  if (nr_replacements == -1)
+  {
+    return false;
+  }
+
+  m_substitute = data;
+
+  // A replacement might add lines.
+  end_line += m_stc->get_line_count() - lines;
+
+  if (m_begin.m_address == "'<" && m_end.m_address == "'>")
+  {
+    m_stc->SetSelection(
+      m_stc->PositionFromLine(begin_line),
+      m_stc->PositionFromLine(end_line + corrected));
+  }
+
+  m_ex->frame()->show_ex_message(
+    "Replaced: " + std::to_string(nr_replacements) +
+    " occurrences of: " + data.pattern());
+
+  m_stc->IndicatorClearRange(0, m_stc->GetTextLength() - 1);
+
+  return true;
+}
+
 bool wex::addressrange::write(const std::string& text) const
 {
   if (!set_selection())
@@ -88,11 +88,17 @@ wex::ex_stream_line::ex_stream_line(
   , m_end(range.get_end().get_line() - 1)
   , m_register(name)
 {
-  ex::get_macros().set_register(m_register, std::string());
 }
 
 wex::ex_stream_line::~ex_stream_line()
 {
+  // The yanked lines are set at once, so a large yank
+  // is stored only once in a register.
+  if (m_action == ACTION_YANK)
+  {
+    ex::get_macros().set_register(m_register, m_yank);
+  }
+
   log::trace("ex stream " + action_name(m_action))
     << m_actions << m_begin << m_end << m_data.pattern()
     << m_data.replacement();
@@ -169,9 +175,7 @@ wex::ex_stream_line::handle_t wex::ex_stream_line::handle(char* line, int& pos)
         break;
 
       case ACTION_YANK:
-        ex::get_macros().set_register(
-          m_register,
-          ex::get_macros().get_register(m_register) + std::string(line, pos));
+        m_yank.append(line, pos);
         m_actions++;
         break;
 
@@ -74,7 +74,8 @@ private:
   const char             m_register{0};
   const int              m_begin, m_end;
 
-  file* m_file;
-  int   m_actions{0}, m_line{0};
+  file*       m_file;
+  int         m_actions{0}, m_line{0};
+  std::string m_yank;
 };
 }; // namespace wex
@@ -6,6 +6,7 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <sstream>
 #include <wx/wxprec.h>
 #ifndef WX_PRECOMP
@@ -32,6 +33,7 @@
 #include <wex/log.h>
 #include <wex/macros.h>
 #include <wex/regex.h>
+#include <wex/register-file.h>
 #include <wex/statusbar.h>
 #include <wex/type-to-value.h>
 #include <wex/version.h>
@@ -401,10 +403,29 @@ wex::ex::ex(wex::factory::stc* stc, mode_t mode)
   assert(m_frame != nullptr);
 
   reset_search_flags();
+
+  // Addressing in ex.
+  const std::string addr(
+    // (1) . (2) $ (3) decimal number, + or - (7)
+    "[\\.\\$0-9\\+\\-]+|"
+    // (4) marker
+    "'[a-z]|"
+    // (5) (6) regex find, non-greedy!
+    "[\\?/].*?[\\?/]");
+
+  // Command Descriptions in ex.
+  m_address_regex = new regex(
+    {// 2addr % range
+     "^%" + addressrange(this).regex_commands(),
+     // 1addr (or none)
+     "^(" + addr + ")?" + address(this).regex_commands(),
+     // 2addr
+     "^(" + addr + ")?(," + addr + ")?" + addressrange(this).regex_commands()});
 }
 
 wex::ex::~ex()
 {
+  delete m_address_regex;
   delete m_ctags;
   delete m_ex_stream;
 }
@@ -431,73 +452,73 @@ bool wex::ex::address_parse(
   {
     marker_and_register_expansion(this, text);
 
-    // Addressing in ex.
-    const std::string addr(
-      // (1) . (2) $ (3) decimal number, + or - (7)
-      "[\\.\\$0-9\\+\\-]+|"
-      // (4) marker
-      "'[a-z]|"
-      // (5) (6) regex find, non-greedy!
-      "[\\?/].*?[\\?/]");
-
-    // Command Descriptions in ex.
-    // 1addr commands
-    const auto& cmds_1addr(address(this).regex_commands());
-
-    // 2addr commands
-    const auto& cmds_2addr(addressrange(this).regex_commands());
-
-    if (regex v({// 2addr % range
-                 {"^%" + cmds_2addr,
-                  [&](const regex::match_t& m)
-                  {
-                    type  = address_t::RANGE;
-                    range = "%";
-                    cmd   = m[0];
-                    text  = m[1];
-                  }},
-                 // 1addr (or none)
-                 {"^(" + addr + ")?" + cmds_1addr,
-                  [&](const regex::match_t& m)
-                  {
-                    type  = address_t::ONE;
-                    range = m[0];
-                    cmd   = (m[1] == "mark" ? "k" : m[1]);
-                    text  = boost::algorithm::trim_left_copy(m[2]);
-                  }},
-                 // 2addr
-                 {"^(" + addr + ")?(," + addr + ")?" + cmds_2addr,
-                  [&](const regex::match_t& m)
-                  {
-                    type  = address_t::RANGE;
-                    range = m[0] + m[1];
-
-                    if (m[2].substr(0, 2) == "co")
-                    {
-                      cmd = "t";
-                    }
-                    else if (m[2].substr(0, 2) == "nu")
-                    {
-                      cmd = "#";
-                    }
-                    else
-                    {
-                      cmd = m[2];
-                    }
-
-                    text = m[3];
-                  }}});
-        v.match(text) <= 1)
+    if (!address_split(text, range, cmd, type))
     {
       type = address_t::NONE;
       const auto line(address(this, text).get_line());
       return get_stc()->inject(data::control().line(line));
     }
+  }
 
-    if (range.empty() && cmd != '!')
-    {
-      range = (cmd == "g" || cmd == 'v' || cmd == 'w' ? "%" : ".");
-    }
+  return true;
+}
+
+bool wex::ex::address_split(
+  std::string& text,
+  std::string& range,
+  std::string& cmd,
+  address_t&   type) const
+{
+  auto& v(*m_address_regex);
+
+  if (v.match(text) <= 1)
+  {
+    return false;
+  }
+
+  switch (v.which_no())
+  {
+    case 0:
+      type  = address_t::RANGE;
+      range = "%";
+      cmd   = v[0];
+      text  = v[1];
+      break;
+
+    case 1:
+      type  = address_t::ONE;
+      range = v[0];
+      cmd   = (v[1] == "mark" ? "k" : v[1]);
+      text  = boost::algorithm::trim_left_copy(v[2]);
+      break;
+
+    case 2:
+      type  = address_t::RANGE;
+      range = v[0] + v[1];
+
+      if (v[2].substr(0, 2) == "co")
+      {
+        cmd = "t";
+      }
+      else if (v[2].substr(0, 2) == "nu")
+      {
+        cmd = "#";
+      }
+      else
+      {
+        cmd = v[2];
+      }
+
+      text = v[3];
+      break;
+
+    default:
+      assert(0);
+  }
+
+  if (range.empty() && cmd != '!')
+  {
+    range = (cmd == "g" || cmd == 'v' || cmd == 'w' ? "%" : ".");
   }
 
   return true;
@@ -529,6 +550,41 @@ int wex::ex::calculator(const std::string& text)
   return val;
 }
 
+const wex::macro_command wex::ex::compile(const std::string& command) const
+{
+  // Only ex commands without markers, registers or a visual range,
+  // and that are not handled by m_commands, are parsed in advance.
+  if (
+    command.size() < 2 || command.front() != ':' || command == ":!" ||
+    command.find_first_of(std::string("'") + (char)WXK_CONTROL_R) !=
+      std::string::npos ||
+    std::any_of(
+      m_commands.begin(),
+      m_commands.end(),
+      [command](auto const& e)
+      {
+        return e.first == command.substr(0, e.first.size());
+      }))
+  {
+    return macro_command(command);
+  }
+
+  std::string range, cmd, rest(command.substr(1));
+
+  if (address_t type; address_split(rest, range, cmd, type))
+  {
+    return macro_command(
+      command,
+      type == address_t::ONE ? macro_command::TYPE_EX_ONE :
+                               macro_command::TYPE_EX_RANGE,
+      range,
+      cmd,
+      rest);
+  }
+
+  return macro_command(command);
+}
+
 bool wex::ex::command(const std::string& cmd)
 {
   auto command(cmd);
@@ -566,6 +622,43 @@ bool wex::ex::command(const std::string& cmd)
   return auto_write();
 }
 
+bool wex::ex::command(const macro_command& command)
+{
+  if (
+    command.type() == macro_command::TYPE_OTHER || m_mode == OFF ||
+    m_macros.get_map().find(command.command()) != m_macros.get_map().end())
+  {
+    return this->command(command.command());
+  }
+
+  log::trace("ex command") << command.command();
+
+  if (m_frame->exec_ex_command(m_command.set(command.command())))
+  {
+    m_macros.record(command.command());
+    m_command.clear();
+    return auto_write();
+  }
+
+  auto rest(command.text());
+
+  if (!command_address(
+        command.type() == macro_command::TYPE_EX_ONE ? address_t::ONE :
+                                                       address_t::RANGE,
+        command.range(),
+        command.cmd(),
+        rest))
+  {
+    m_command.clear();
+    return false;
+  }
+
+  m_macros.record(command.command());
+  m_command.clear();
+
+  return auto_write();
+}
+
 bool wex::ex::command_address(const std::string& command)
 {
   std::string range, cmd, rest(command);
@@ -576,6 +669,15 @@ bool wex::ex::command_address(const std::string& command)
     return false;
   }
 
+  return command_address(type, range, cmd, rest);
+}
+
+bool wex::ex::command_address(
+  address_t          type,
+  const std::string& range,
+  const std::string& cmd,
+  std::string&       rest)
+{
   try
   {
     switch (type)
@@ -597,7 +699,16 @@ bool wex::ex::command_address(const std::string& command)
         }
         else if (im != info_message_t::NONE)
         {
-          info_message(register_text(), im);
+          if (const auto& rf(m_macros.get_register_file(
+                m_register ? m_register : '0'));
+              rf != nullptr)
+          {
+            info_message(rf->view(), im);
+          }
+          else
+          {
+            info_message(register_text(), im);
+          }
         }
         break;
 
@@ -607,7 +718,7 @@ bool wex::ex::command_address(const std::string& command)
   }
   catch (std::exception& e)
   {
-    log(e) << command;
+    log(e) << cmd << rest;
     return false;
   }
 
@@ -865,11 +976,24 @@ bool wex::ex::handle_container(
   return true;
 }
 
-void wex::ex::info_message(const std::string& text, wex::info_message_t type)
-  const
+void wex::ex::info_message(
+  const std::string_view& text,
+  wex::info_message_t     type) const
 {
-  if (const auto lines = get_number_of_lines(text);
-      lines > config("stc.Reported lines").get(5))
+  if (text.empty())
+  {
+    return;
+  }
+
+  // As get_number_of_lines, without copying the (possibly large) text.
+  auto lines = std::count(text.begin(), text.end(), '\n') + 1;
+
+  if (lines == 1)
+  {
+    lines = std::count(text.begin(), text.end(), '\r') + 1;
+  }
+
+  if (lines > config("stc.Reported lines").get(5))
   {
     wxString msg;
 
@@ -1094,11 +1218,9 @@ void wex::ex::set_registers_delete(const std::string& value)
 
   for (int i = 9; i >= 2; i--)
   {
-    if (const auto value(m_macros.get_register(static_cast<char>(48 + i - 1)));
-        !value.empty())
-    {
-      m_macros.set_register(static_cast<char>(48 + i), value);
-    }
+    m_macros.copy_register(
+      static_cast<char>(48 + i - 1),
+      static_cast<char>(48 + i));
   }
 
   m_macros.set_register('1', value);
@@ -192,8 +192,8 @@ bool wex::macro_fsm::expanding_variable(
   }
 
   var->set_ask_for_input(false);
-  m_mode->get_macros()->m_is_modified = true;
   var->save(node, value);
+  m_mode->get_macros()->journal("variable", name);
   log::status(_("Variable expanded"));
 
   return true;
@@ -224,18 +224,20 @@ void wex::macro_fsm::playback(const std::string& macro, ex* ex, int repeat)
     m_macro = macro;
   }
 
-  const auto& commands(m_mode->get_macros()->get_macro_commands(macro));
+  // The compiled macro is kept alive during playback, even if the
+  // macro itself is changed by one of its commands.
+  const auto commands(m_mode->get_macros()->get_macro_compiled(macro, ex));
 
   for (int i = 0; i < repeat && !error; i++)
   {
     if (!std::all_of(
-          commands.begin(),
-          commands.end(),
+          commands->begin(),
+          commands->end(),
           [ex](const auto& i)
           {
             if (!ex->command(i))
             {
-              log::status(_("Macro aborted at")) << i;
+              log::status(_("Macro aborted at")) << i.command();
               return false;
             }
             return true;
@@ -387,6 +389,7 @@ void wex::macro_fsm::state(state_t s)
       // (otherwise append to the macro).
       if (islower(m_macro[0]))
       {
+        m_mode->get_macros()->m_compiled.erase(m_macro);
         m_mode->get_macros()->m_macros[m_macro].clear();
       }
 
@@ -400,6 +403,7 @@ void wex::macro_fsm::state(state_t s)
     }
     else
     {
+      m_mode->get_macros()->m_compiled.erase(m_macro);
       m_mode->get_macros()->m_macros[m_macro].clear();
     }
   }
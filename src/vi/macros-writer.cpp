@@ -0,0 +1,313 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      macros-writer.cpp
+// Purpose:   Implementation of class wex::macros_writer
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <wex/log.h>
+
+#include "macros-writer.h"
+
+namespace wex
+{
+/// Returns element name of a (journaled) node.
+const std::string element_name(const pugi::xml_node& node)
+{
+  return strcmp(node.name(), "removed") == 0 ?
+           node.attribute("element").value() :
+           node.name();
+}
+
+/// Removes nodes with element name and name attribute from root.
+/// Returns true if a node was removed.
+bool remove_nodes(
+  pugi::xml_node     root,
+  const std::string& element,
+  const std::string& name)
+{
+  bool removed = false;
+
+  for (auto child = root.first_child(); child;)
+  {
+    const auto next = child.next_sibling();
+
+    if (
+      element_name(child) == element &&
+      child.attribute("name").value() == name)
+    {
+      root.remove_child(child);
+      removed = true;
+    }
+
+    child = next;
+  }
+
+  return removed;
+}
+
+/// Returns the lock file for the document, it is kept in the temp dir,
+/// as it cannot be removed safely while other instances might use it.
+/// The name uses a (FNV-1a) hash of the document, that is the same
+/// for all instances.
+const std::string lock_file(const std::string& file)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (const auto c : file)
+  {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+  }
+
+  return (std::filesystem::temp_directory_path() /
+          ("wex-macros-" + std::to_string(hash) + ".lck"))
+    .string();
+}
+} // namespace wex
+
+wex::macros_writer::macros_writer(std::chrono::milliseconds delay)
+  : m_delay(delay)
+{
+  m_journal.append_child("macros");
+}
+
+wex::macros_writer::~macros_writer()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_cv.notify_one();
+
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+bool wex::macros_writer::flush()
+{
+  std::lock_guard<std::mutex> flush_lock(m_flush_mutex);
+
+  pugi::xml_document journal;
+  std::string        file;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_journal.document_element().first_child())
+    {
+      return false;
+    }
+
+    journal.reset(m_journal);
+    m_journal.reset();
+    m_journal.append_child("macros");
+    file = m_file;
+  }
+
+  if (flush(file, journal))
+  {
+    return true;
+  }
+
+  // Keep the journal for a next flush, unless a node was journaled again.
+  // It is not flushed again until a next change, to not retry forever.
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (const auto& child : journal.document_element().children())
+  {
+    if (const auto& root(m_journal.document_element()); std::none_of(
+          root.children().begin(),
+          root.children().end(),
+          [&child](const auto& n)
+          {
+            return element_name(n) == element_name(child) &&
+                   strcmp(
+                     n.attribute("name").value(),
+                     child.attribute("name").value()) == 0;
+          }))
+    {
+      m_journal.document_element().append_copy(child);
+    }
+  }
+
+  return false;
+}
+
+bool wex::macros_writer::flush(
+  const std::string&        file,
+  const pugi::xml_document& journal)
+{
+  if (!std::filesystem::exists(file))
+  {
+    log("macros flush no document") << file;
+    return false;
+  }
+
+  try
+  {
+    // Other instances use the same lock, and we read the document
+    // from disk, so no changes get lost.
+    const auto lck(lock_file(file));
+    std::ofstream(lck, std::ios::app);
+    boost::interprocess::file_lock fl(lck.c_str());
+    boost::interprocess::scoped_lock<boost::interprocess::file_lock> lock(fl);
+
+    pugi::xml_document doc;
+
+    if (const auto result = doc.load_file(
+          file.c_str(),
+          pugi::parse_default | pugi::parse_comments);
+        !result)
+    {
+      log("macros flush") << file << result.description();
+      return false;
+    }
+
+    for (const auto& child : journal.document_element().children())
+    {
+      remove_nodes(
+        doc.document_element(),
+        element_name(child),
+        child.attribute("name").value());
+
+      if (strcmp(child.name(), "removed") != 0)
+      {
+        doc.document_element().append_copy(child);
+      }
+    }
+
+    return save(file, doc);
+  }
+  catch (std::exception& e)
+  {
+    log(e) << "macros flush" << file;
+    return false;
+  }
+}
+
+bool wex::macros_writer::is_pending() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return !m_journal.document_element().first_child().empty();
+}
+
+void wex::macros_writer::journal(
+  const std::string&    file,
+  const std::string&    element,
+  const std::string&    name,
+  const pugi::xml_node& node)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto root(m_journal.document_element());
+    remove_nodes(root, element, name);
+
+    if (node)
+    {
+      root.append_copy(node);
+    }
+    else
+    {
+      auto removed = root.append_child("removed");
+      removed.append_attribute("element") = element.c_str();
+      removed.append_attribute("name")    = name.c_str();
+    }
+
+    m_armed    = true;
+    m_file     = file;
+    m_deadline = std::chrono::steady_clock::now() + m_delay;
+
+    if (!m_thread.joinable())
+    {
+      m_thread = std::thread(
+        [this]
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+
+          while (!m_stop)
+          {
+            if (!m_armed)
+            {
+              m_cv.wait(lock);
+            }
+            else if (std::chrono::steady_clock::now() < m_deadline)
+            {
+              m_cv.wait_until(lock, m_deadline);
+            }
+            else
+            {
+              m_armed = false;
+              lock.unlock();
+              flush();
+              lock.lock();
+            }
+          }
+        });
+    }
+  }
+
+  m_cv.notify_one();
+}
+
+bool wex::macros_writer::save(
+  const std::string&        file,
+  const pugi::xml_document& doc)
+{
+  const std::string temp(file + ".tmp");
+
+  if (!doc.save_file(temp.c_str(), "  "))
+  {
+    log("macros save") << temp;
+    return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(temp, file, ec);
+
+  if (ec)
+  {
+    log("macros rename") << temp << ec.message();
+    return false;
+  }
+
+  return true;
+}
+
+bool wex::macros_writer::write(
+  const std::string&        file,
+  const pugi::xml_document& doc)
+{
+  std::lock_guard<std::mutex> flush_lock(m_flush_mutex);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_armed = false;
+    m_journal.reset();
+    m_journal.append_child("macros");
+  }
+
+  try
+  {
+    const auto lck(lock_file(file));
+    std::ofstream(lck, std::ios::app);
+    boost::interprocess::file_lock fl(lck.c_str());
+    boost::interprocess::scoped_lock<boost::interprocess::file_lock> lock(fl);
+
+    return save(file, doc);
+  }
+  catch (std::exception& e)
+  {
+    log(e) << "macros write" << file;
+    return false;
+  }
+}
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      macros-writer.h
+// Purpose:   Declaration of class wex::macros_writer
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <pugixml.hpp>
+#include <string>
+#include <thread>
+
+namespace wex
+{
+/// Offers write behind persistence of the macros document.
+/// Each changed node is journaled (a copy of the node is kept),
+/// and after a delay without changes the journal is flushed by a thread.
+/// A flush reads the document from disk (so changes from other
+/// instances are kept), applies the journal, and writes the document
+/// using a temp file that is renamed, all while holding a file lock.
+/// If a flush fails, the journal is kept, but not flushed
+/// again until a next change or an explicit flush.
+class macros_writer
+{
+public:
+  /// Constructor.
+  explicit macros_writer(
+    /// the delay after the last change before flushing
+    std::chrono::milliseconds delay = std::chrono::milliseconds(1000));
+
+  /// Destructor, stops the thread.
+  /// The journal is not flushed, as this might be during static
+  /// destruction, flush it before (e.g. on app exit).
+  ~macros_writer();
+
+  /// Flushes the journal now.
+  /// Returns false if journal was empty, or flush failed.
+  bool flush();
+
+  /// Returns true if journal is not yet flushed.
+  bool is_pending() const;
+
+  /// Journals a node.
+  void journal(
+    /// the document file
+    const std::string& file,
+    /// the node name
+    const std::string& element,
+    /// the value of the name attribute
+    const std::string& name,
+    /// the node, if empty the node is removed
+    const pugi::xml_node& node);
+
+  /// Writes the complete document now, and clears the journal.
+  bool write(const std::string& file, const pugi::xml_document& doc);
+
+private:
+  bool flush(const std::string& file, const pugi::xml_document& journal);
+  bool save(const std::string& file, const pugi::xml_document& doc);
+
+  const std::chrono::milliseconds m_delay;
+
+  std::chrono::steady_clock::time_point m_deadline;
+  std::condition_variable               m_cv;
+  std::string                           m_file;
+  std::thread                           m_thread;
+  pugi::xml_document                    m_journal;
+
+  mutable std::mutex m_mutex;
+  std::mutex         m_flush_mutex;
+
+  bool m_armed{false}, m_stop{false};
+};
+}; // namespace wex
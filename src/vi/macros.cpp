@@ -5,26 +5,63 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <numeric>
 #include <wex/app.h>
 #include <wex/config.h>
 #include <wex/core.h>
+#include <wex/ex.h>
 #include <wex/frame.h>
 #include <wex/lexer-props.h>
 #include <wex/log.h>
 #include <wex/macros.h>
 #include <wex/path.h>
+#include <wex/register-file.h>
 #include <wex/type-to-value.h>
 #include <wex/util.h>
 
+#include "macros-writer.h"
+
 wex::macros::macros()
   : m_mode(this)
+  , m_writer(std::make_unique<macros_writer>())
+{
+}
+
+wex::macros::~macros() = default;
+
+bool wex::macros::copy_register(char from, char to)
 {
+  if (const auto& it = m_register_files.find(from);
+      it != m_register_files.end())
+  {
+    if (from != to)
+    {
+      const std::string reg(1, to);
+
+      release_register_file(to);
+      m_compiled.erase(reg);
+      m_macros.erase(reg);
+      m_register_files[to] = it->second;
+      save_macro(reg);
+    }
+
+    return true;
+  }
+
+  if (const auto& value(get_register(from)); !value.empty())
+  {
+    return set_register(to, value);
+  }
+
+  return false;
 }
 
 bool wex::macros::erase()
 {
+  m_compiled.erase(m_mode.get_macro());
+
   if (m_macros.erase(m_mode.get_macro()) == 0)
   {
     log("erase macro") << m_mode.get_macro();
@@ -100,6 +137,26 @@ wex::macros::get_macro_commands(const std::string& macro) const
   return (it != m_macros.end()) ? it->second : std::vector<std::string>();
 }
 
+wex::macros::compiled_t
+wex::macros::get_macro_compiled(const std::string& macro, const ex* ex)
+{
+  if (const auto& it = m_compiled.find(macro); it != m_compiled.end())
+  {
+    return it->second;
+  }
+
+  auto v = std::make_shared<std::vector<macro_command>>();
+
+  for (const auto& it : get_macro_commands(macro))
+  {
+    v->emplace_back(ex->compile(it));
+  }
+
+  log::trace("macro compiled") << macro << v->size();
+
+  return m_compiled.insert({macro, v}).first->second;
+}
+
 const std::string wex::macros::get_register(char name) const
 {
   switch (name)
@@ -110,6 +167,12 @@ const std::string wex::macros::get_register(char name) const
 
     default:
     {
+      if (const auto& it = m_register_files.find(name);
+          it != m_register_files.end())
+      {
+        return it->second->text();
+      }
+
       const auto& it = m_macros.find(std::string(1, name));
       return it != m_macros.end() ? std::accumulate(
                                       it->second.begin(),
@@ -120,6 +183,13 @@ const std::string wex::macros::get_register(char name) const
   }
 }
 
+std::shared_ptr<wex::register_file>
+wex::macros::get_register_file(char name) const
+{
+  const auto& it = m_register_files.find(name);
+  return it != m_register_files.end() ? it->second : nullptr;
+}
+
 const std::vector<std::string> wex::macros::get_registers() const
 {
   std::vector<std::string> r;
@@ -145,6 +215,11 @@ const std::vector<std::string> wex::macros::get_registers() const
   return r;
 }
 
+bool wex::macros::is_modified() const
+{
+  return m_writer->is_pending();
+}
+
 bool wex::macros::is_recorded(const std::string& macro) const
 {
   return !find(macro).empty();
@@ -155,6 +230,26 @@ bool wex::macros::is_recorded_macro(const std::string& macro) const
   return m_macros.find(macro) != m_macros.end();
 }
 
+void wex::macros::journal(const std::string& element, const std::string& name)
+{
+  if (!m_is_loaded)
+  {
+    return;
+  }
+
+  pugi::xml_node node;
+
+  for (const auto& child : m_doc.document_element().children(element.c_str()))
+  {
+    if (name == child.attribute("name").value())
+    {
+      node = child;
+    }
+  }
+
+  m_writer->journal(path().string(), element, name, node);
+}
+
 bool wex::macros::load_document()
 {
   if (!path().file_exists())
@@ -162,6 +257,9 @@ bool wex::macros::load_document()
     return false;
   }
 
+  // Changes not yet saved should be part of the loaded document.
+  m_writer->flush();
+
   if (const auto result = m_doc.load_file(
         path().string().c_str(),
         pugi::parse_default | pugi::parse_comments);
@@ -171,10 +269,10 @@ bool wex::macros::load_document()
     return false;
   }
 
-  m_is_modified = false;
-
   m_abbreviations.clear();
+  m_compiled.clear();
   m_macros.clear();
+  m_register_files.clear();
   m_map.clear();
   m_map_alt_keys.clear();
   m_map_control_keys.clear();
@@ -254,6 +352,19 @@ void wex::macros::parse_node_macro(const pugi::xml_node& node)
   {
     log("duplicate macro") << name << node << it->second.front();
   }
+  else if (const std::string file(node.attribute("file").value());
+           !file.empty())
+  {
+    if (const auto& rf = std::make_shared<register_file>(wex::path(file));
+        name.size() == 1 && rf->is_ok())
+    {
+      m_register_files[name.front()] = rf;
+    }
+    else
+    {
+      log("register file") << name << file;
+    }
+  }
   else
   {
     std::vector<std::string> v;
@@ -306,6 +417,8 @@ bool wex::macros::record(const std::string& text, bool new_command)
     return false;
   }
 
+  m_compiled.erase(m_mode.get_macro());
+
   if (new_command)
   {
     m_macros[m_mode.get_macro()].emplace_back(text == " " ? "l" : text);
@@ -331,23 +444,40 @@ bool wex::macros::record(const std::string& text, bool new_command)
   return true;
 }
 
-bool wex::macros::save_document(bool only_if_modified)
+void wex::macros::release_register_file(char name)
 {
-  if (
-    !m_is_loaded || !path().file_exists() ||
-    (!m_is_modified && only_if_modified))
-  {
-    return false;
+  // If no other register refers to the file, it is released, and removed
+  // by the destructor of the register file, when the last reference
+  // (e.g. one used while putting the register) is gone.
+  if (const auto& it = m_register_files.find(name);
+      it != m_register_files.end())
+  {
+    const auto rf(it->second);
+
+    m_register_files.erase(it);
+
+    if (std::none_of(
+          m_register_files.begin(),
+          m_register_files.end(),
+          [&rf](const auto& other)
+          {
+            return other.second == rf;
+          }))
+    {
+      rf->release();
+    }
   }
+}
 
-  const bool ok = m_doc.save_file(path().string().c_str(), "  ");
-
-  if (ok)
+bool wex::macros::save_document(bool only_if_modified)
+{
+  if (!m_is_loaded || !path().file_exists())
   {
-    m_is_modified = false;
+    return false;
   }
 
-  return ok;
+  return only_if_modified ? m_writer->flush() :
+                            m_writer->write(path().string(), m_doc);
 }
 
 void wex::macros::save_macro(const std::string& macro)
@@ -364,14 +494,21 @@ void wex::macros::save_macro(const std::string& macro)
     auto node_macro = m_doc.document_element().append_child("macro");
     node_macro.append_attribute("name") = macro.c_str();
 
-    for (const auto& it : m_macros[macro])
+    if (const auto& rf(
+          macro.size() == 1 ? get_register_file(macro.front()) : nullptr);
+        rf != nullptr)
     {
-      node_macro.append_child("command").text().set(it.c_str());
+      node_macro.append_attribute("file") = rf->name().c_str();
+    }
+    else
+    {
+      for (const auto& it : m_macros[macro])
+      {
+        node_macro.append_child("command").text().set(it.c_str());
+      }
     }
 
-    m_is_modified = true;
-
-    save_document();
+    journal("macro", macro);
   }
   catch (pugi::xpath_exception& e)
   {
@@ -408,7 +545,7 @@ void wex::macros::set(
       container[type_to_value<S>(name).get()] = value;
     }
 
-    m_is_modified = true;
+    journal(xpath, name);
   }
   catch (pugi::xpath_exception& e)
   {
@@ -479,8 +616,32 @@ bool wex::macros::set_register(char name, const std::string& value)
     }
   }
 
-  m_macros[std::string(1, static_cast<char>(tolower(name)))] = v;
-  save_macro(std::string(1, static_cast<char>(tolower(name))));
+  const std::string reg(1, static_cast<char>(tolower(name)));
+
+  release_register_file(reg.front());
+  m_compiled.erase(reg);
+
+  if (
+    !v.empty() &&
+    v.front().size() > (size_t)config("stc.max.Size register").get(1000000))
+  {
+    if (const auto& rf =
+          std::make_shared<register_file>(config::dir(), v.front());
+        rf->is_ok())
+    {
+      m_macros.erase(reg);
+      m_register_files[reg.front()] = rf;
+      save_macro(reg);
+      return true;
+    }
+    else
+    {
+      rf->release();
+    }
+  }
+
+  m_macros[reg] = v;
+  save_macro(reg);
 
   return true;
 }
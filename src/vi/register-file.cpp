@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      register-file.cpp
+// Purpose:   Implementation of class wex::register_file
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <wex/log.h>
+#include <wex/register-file.h>
+
+namespace wex
+{
+// Returns a new filename in the dir.
+const std::string register_filename(const path& dir, int& no)
+{
+  while (true)
+  {
+    if (const path p(
+          dir,
+          "wex-register-" + std::to_string(std::time(nullptr)) + "-" +
+            std::to_string(no++));
+        !p.file_exists())
+    {
+      return p.string();
+    }
+  }
+}
+}; // namespace wex
+
+wex::register_file::register_file(const path& dir, const std::string& text)
+  : m_name(register_filename(dir, m_no))
+{
+  if (std::ofstream fs(m_name, std::ios::binary);
+      !fs.write(text.data(), text.size()))
+  {
+    log("register file write") << m_name;
+    return;
+  }
+
+  map();
+}
+
+wex::register_file::register_file(const path& p)
+  : m_name(p.string())
+{
+  map();
+}
+
+wex::register_file::~register_file()
+{
+  if (m_is_released)
+  {
+    // The region and mapping should be gone before removing the file.
+    m_region  = boost::interprocess::mapped_region();
+    m_mapping = boost::interprocess::file_mapping();
+
+    if (remove(m_name.c_str()) != 0)
+    {
+      log("could not remove file") << m_name;
+    }
+  }
+}
+
+void wex::register_file::map()
+{
+  try
+  {
+    m_mapping = boost::interprocess::file_mapping(
+      m_name.c_str(),
+      boost::interprocess::read_only);
+    m_region = boost::interprocess::mapped_region(
+      m_mapping,
+      boost::interprocess::read_only);
+    m_is_ok = true;
+  }
+  catch (std::exception& e)
+  {
+    log(e) << "register file" << m_name;
+  }
+}
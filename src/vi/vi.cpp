@@ -22,11 +22,14 @@
 #include <wex/log.h>
 #include <wex/macro-mode.h>
 #include <wex/macros.h>
-#include <wex/regex.h>
+#include <wex/register-file.h>
 #include <wex/vi.h>
 
 namespace wex
 {
+// The motions that are compiled for macro playback.
+const std::string c_compiled_motions("bBeEhjklwW");
+
 constexpr int c_strcmp(char const* lhs, char const* rhs)
 {
   return (('\0' == lhs[0]) && ('\0' == rhs[0])) ? 0 :
@@ -43,6 +46,56 @@ const std::string _s(wxKeyCode key)
 {
   return std::string(1, key);
 }
+
+/// Returns the size of a leading count (like 3 in 3w) of the command,
+/// or 0 if there is no count.
+size_t count_size(const std::string& command)
+{
+  if (command.empty() || command[0] < '1' || command[0] > '9')
+  {
+    return 0;
+  }
+
+  size_t size = 1;
+
+  while (size < command.size() && isdigit(command[size]))
+  {
+    size++;
+  }
+
+  return size;
+}
+
+/// Returns the jump table for the commands.
+/// If any_char is set, or the command does not start with an alpha char,
+/// each char of the command handles the command,
+/// otherwise only the first char handles the command (and then
+/// the command should be a prefix).
+template <typename T>
+std::array<std::vector<size_t>, 256>
+make_index(const T& commands, bool any_char)
+{
+  std::array<std::vector<size_t>, 256> index;
+
+  for (size_t i = 0; i < commands.size(); i++)
+  {
+    const auto& key(commands[i].first);
+
+    if (any_char || !isalpha(key.front()))
+    {
+      for (const auto& c : key)
+      {
+        index[static_cast<unsigned char>(c)].emplace_back(i);
+      }
+    }
+    else
+    {
+      index[static_cast<unsigned char>(key.front())].emplace_back(i);
+    }
+  }
+
+  return index;
+}
 } // namespace wex
 
 #define MOTION(SCOPE, DIRECTION, COND, WRAP)                                \
@@ -855,6 +908,8 @@ wex::vi::vi(wex::factory::stc* arg, mode_t ex_mode)
            get_stc()->GetCurrentPos() + m_count);
          return 1;
        }}}
+  , m_motion_index(make_index(m_motion_commands, true))
+  , m_other_index(make_index(m_other_commands, false))
 {
 }
 
@@ -925,6 +980,81 @@ bool wex::vi::command(const std::string& command)
   }
 }
 
+bool wex::vi::command(const macro_command& command)
+{
+  // A compiled command is only executed as such in command mode,
+  // otherwise it is handled as the command it was recorded from.
+  if (
+    command.type() == macro_command::TYPE_OTHER || !is_active() ||
+    !m_mode.is_command() ||
+    get_macros().get_keys_map().find(command.command().front()) !=
+      get_macros().get_keys_map().end())
+  {
+    return this->command(command.command());
+  }
+
+  if (command.type() == macro_command::TYPE_VI_MOTION)
+  {
+    set_register(0);
+    m_insert_command.clear();
+
+    m_count         = command.count();
+    m_count_present = command.command().size() > 1;
+
+    const auto& motion(m_motion_commands[command.motion()]);
+    const auto  parsed =
+      motion.second(command.command().substr(command.command().size() - 1));
+
+    m_count         = 1;
+    m_count_present = false;
+
+    if (parsed == 0)
+    {
+      return false;
+    }
+
+    get_macros().record(command.command());
+
+    return auto_write();
+  }
+
+  m_count = 1;
+
+  if (!ex::command(command))
+  {
+    return false;
+  }
+
+  if (!m_dot)
+  {
+    set_last_command(command.command());
+  }
+
+  return auto_write();
+}
+
+const wex::macro_command wex::vi::compile(const std::string& command) const
+{
+  // Only motions that only move the caret, and
+  // that do not change the mode, are compiled.
+  if (const auto size = count_size(command);
+      command.size() == size + 1 &&
+      c_compiled_motions.find(command.back()) != std::string::npos)
+  {
+    if (const auto& index(
+          m_motion_index[static_cast<unsigned char>(command.back())]);
+        !index.empty())
+    {
+      return macro_command(
+        command,
+        size > 0 ? std::stoi(command.substr(0, size)) : 1,
+        index.front());
+    }
+  }
+
+  return ex::compile(command);
+}
+
 void wex::vi::command_reg(const std::string& reg)
 {
   switch (reg[0])
@@ -1093,26 +1223,24 @@ void wex::vi::filter_count(std::string& command)
 {
   /*
    command: 3w
-   -> v has 2 elements
    -> m_count 3
    -> command w
    */
-  if (regex v("^([1-9][0-9]*)(.*)"); v.match(command) == 2)
+  if (const auto size = count_size(command); size > 0)
   {
     try
     {
-      m_count_present  = true;
-      const auto count = std::stoi(v[0]);
-      m_count *= count;
-      append_insert_command(v[0]);
-      command = v[1];
+      m_count_present = true;
+      m_count *= std::stoi(command.substr(0, size));
+      append_insert_command(command.substr(0, size));
     }
     catch (std::exception& e)
     {
       m_count_present = false;
       log(e) << command;
-      command = v[1];
     }
+
+    command.erase(0, size);
   }
 }
 
@@ -1388,25 +1516,15 @@ bool wex::vi::motion_command(motion_t type, std::string& command)
 
   filter_count(command);
 
-  const auto& it = std::find_if(
-    m_motion_commands.begin(),
-    m_motion_commands.end(),
-    [&](auto const& e)
-    {
-      return std::any_of(
-        e.first.begin(),
-        e.first.end(),
-        [command](const auto& p)
-        {
-          return p == command[0];
-        });
-    });
+  const auto& index(m_motion_index[static_cast<unsigned char>(command[0])]);
 
-  if (it == m_motion_commands.end())
+  if (index.empty())
   {
     return false;
   }
 
+  const auto it = m_motion_commands.begin() + index.front();
+
   int  parsed = 0;
   auto start  = get_stc()->GetCurrentPos();
 
@@ -1681,32 +1799,24 @@ bool wex::vi::other_command(std::string& command)
 
   filter_count(command);
 
-  if (const auto& it = std::find_if(
-        m_other_commands.begin(),
-        m_other_commands.end(),
-        [command](auto const& e)
-        {
-          if (!isalpha(e.first.front()))
-          {
-            return std::any_of(
-              e.first.begin(),
-              e.first.end(),
-              [command](const auto& p)
-              {
-                return p == command.front();
-              });
-          }
-          else
-          {
-            return e.first == command.substr(0, e.first.size());
-          }
-        });
-      it != m_other_commands.end())
+  if (command.empty())
+  {
+    return false;
+  }
+
+  for (const auto i : m_other_index[static_cast<unsigned char>(command[0])])
   {
-    if (const auto parsed = it->second(command); parsed > 0)
+    if (const auto& it = m_other_commands.begin() + i;
+        !isalpha(it->first.front()) ||
+        command.compare(0, it->first.size(), it->first) == 0)
     {
-      command = command.substr(parsed);
-      return true;
+      if (const auto parsed = it->second(command); parsed > 0)
+      {
+        command = command.substr(parsed);
+        return true;
+      }
+
+      return false;
     }
   }
 
@@ -1842,13 +1952,26 @@ bool wex::vi::parse_command(std::string& command)
 
 bool wex::vi::put(bool after)
 {
-  if (register_text().empty())
+  const auto& file(
+    get_macros().get_register_file(register_name() ? register_name() : '0'));
+  const auto& text(file == nullptr ? register_text() : std::string());
+
+  if (file == nullptr && text.empty())
   {
     return false;
   }
 
   // do not trim
-  const bool yanked_lines = (get_number_of_lines(register_text(), false) > 1);
+  const bool yanked_lines =
+    (file == nullptr ?
+       get_number_of_lines(text, false) > 1 :
+       std::any_of(
+         file->data(),
+         file->data() + file->size(),
+         [](char c)
+         {
+           return c == '\n' || c == '\r';
+         }));
 
   if (yanked_lines)
   {
@@ -1865,7 +1988,31 @@ bool wex::vi::put(bool after)
     get_stc()->Home();
   }
 
-  get_stc()->add_text(register_text());
+  if (file == nullptr)
+  {
+    get_stc()->add_text(text);
+  }
+  else if (visual() == EX || get_stc()->GetOvertype())
+  {
+    get_stc()->add_text(file->text());
+  }
+  else
+  {
+    // Add a large register directly from its mapped file, in blocks.
+    const size_t block = 1048576;
+
+    get_stc()->BeginUndoAction();
+    get_stc()->Allocate(get_stc()->GetTextLength() + file->size());
+
+    for (size_t pos = 0; pos < file->size(); pos += block)
+    {
+      get_stc()->AddTextRaw(
+        file->data() + pos,
+        std::min(block, file->size() - pos));
+    }
+
+    get_stc()->EndUndoAction();
+  }
 
   if (yanked_lines && after)
   {
@@ -1877,12 +2024,8 @@ bool wex::vi::put(bool after)
 
 void wex::vi::set_last_command(const std::string& command)
 {
-  size_t first = 0;
-
-  if (regex v("^([1-9][0-9]*)(.*)"); v.match(command) == 2)
-  {
-    first = v[0].size(); // skip a possible leading count
-  }
+  // skip a possible leading count
+  const auto first = count_size(command);
 
   if (const auto& it = std::find(
         m_last_commands.begin(),
@@ -15,6 +15,7 @@ TEST_CASE("wex::debug_entry")
   SUBCASE("default constructor")
   {
     REQUIRE(wex::debug_entry().get_commands().empty());
+    REQUIRE(!wex::debug_entry().is_mi());
   }
 
   SUBCASE("constructor using xml")
@@ -25,6 +26,7 @@ TEST_CASE("wex::debug_entry")
           name=\"gdb\" \
           extensions=\"*.cpp;*.h\" \
           flags=\"-XXX\"\
+          mi=\"true\"\
           regex-at-line=\"x.*yz\" \
           break-set=\"b\" \
           break-del=\"break delete\">\
@@ -35,6 +37,7 @@ TEST_CASE("wex::debug_entry")
     REQUIRE(entry.break_set() == "b");
     REQUIRE(entry.extensions() == "*.cpp;*.h");
     REQUIRE(entry.flags() == "-XXX");
+    REQUIRE(entry.is_mi());
     REQUIRE(entry.regex_stdout(wex::debug_entry::regex_t::AT_LINE) == "x.*yz");
     REQUIRE(entry.regex_stdout(wex::debug_entry::regex_t::PATH).empty());
   }
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      test-mi-parser.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include "../test.h"
+#include <wex/mi-parser.h>
+
+TEST_SUITE_BEGIN("wex::process");
+
+TEST_CASE("wex::mi_parser")
+{
+  // A recorded gdb --interpreter=mi session: file, break, run, print.
+  const std::string transcript(
+    "=thread-group-added,id=\"i1\"\n"
+    "~\"Reading symbols from /tmp/a.out...\\n\"\n"
+    "(gdb) \n"
+    "&\"br example.cc:5\\n\"\n"
+    "~\"Breakpoint 1 at 0x1151: file example.cc, line 5.\\n\"\n"
+    "=breakpoint-created,bkpt={number=\"1\",type=\"breakpoint\","
+    "disp=\"keep\",enabled=\"y\",addr=\"0x0000000000001151\","
+    "func=\"main()\",file=\"example.cc\",fullname=\"/tmp/example.cc\","
+    "line=\"5\",thread-groups=[\"i1\"],times=\"0\"}\n"
+    "^done\n"
+    "(gdb) \n"
+    "*running,thread-id=\"all\"\n"
+    "*stopped,reason=\"breakpoint-hit\",disp=\"keep\",bkptno=\"1\","
+    "frame={addr=\"0x0000555555555151\",func=\"main\",args=[],"
+    "file=\"example.cc\",fullname=\"/tmp/example.cc\",line=\"5\"},"
+    "thread-id=\"1\",stopped-threads=\"all\",core=\"3\"\r\n"
+    "&\"print x\\n\"\n"
+    "~\"$1 = {a = 1, \\\"b\\\" = 2}\\n\"\n"
+    "^done\n"
+    "12^done,value=\"42\"\n"
+    "^error,msg=\"No symbol \\\"y\\\" in current context.\"\n"
+    "=breakpoint-deleted,id=\"1\"\n"
+    "*stopped,reason=\"exited-normally\"\n"
+    "(gdb) \n");
+
+  SUBCASE("events")
+  {
+    wex::mi_parser parser;
+    const auto&    events(parser.feed(transcript));
+
+    REQUIRE(events.size() == 9);
+
+    REQUIRE(events[0].type == wex::mi_parser::event::PATH);
+    REQUIRE(events[0].file == "/tmp/a.out");
+
+    REQUIRE(events[1].type == wex::mi_parser::event::BREAKPOINT_CREATED);
+    REQUIRE(events[1].no == "1");
+    REQUIRE(events[1].file == "/tmp/example.cc");
+    REQUIRE(events[1].line == 5);
+
+    REQUIRE(events[2].type == wex::mi_parser::event::RUNNING);
+
+    REQUIRE(events[3].type == wex::mi_parser::event::STOPPED);
+    REQUIRE(events[3].no == "1");
+    REQUIRE(events[3].file == "/tmp/example.cc");
+    REQUIRE(events[3].line == 5);
+    REQUIRE(events[3].text == "breakpoint-hit");
+
+    REQUIRE(events[4].type == wex::mi_parser::event::VARIABLE);
+    REQUIRE(events[4].text == "{a = 1, \"b\" = 2}");
+
+    REQUIRE(events[5].type == wex::mi_parser::event::VARIABLE);
+    REQUIRE(events[5].text == "42");
+
+    REQUIRE(events[6].type == wex::mi_parser::event::ERROR_MSG);
+    REQUIRE(events[6].text == "No symbol \"y\" in current context.");
+
+    REQUIRE(events[7].type == wex::mi_parser::event::BREAKPOINT_DELETED);
+    REQUIRE(events[7].no == "1");
+
+    REQUIRE(events[8].type == wex::mi_parser::event::EXITED);
+    REQUIRE(events[8].text == "exited-normally");
+  }
+
+  SUBCASE("chunks")
+  {
+    // Records split over chunks give the same events.
+    for (size_t size : {1, 2, 7, 64, 1000})
+    {
+      CAPTURE(size);
+      wex::mi_parser parser;
+      size_t         count = 0;
+
+      for (size_t i = 0; i < transcript.size(); i += size)
+      {
+        count += parser.feed(transcript.substr(i, size)).size();
+      }
+
+      REQUIRE(count == 9);
+    }
+
+    wex::mi_parser parser;
+    REQUIRE(parser.feed("*stopped,reason=\"end-stepping-range\",fra").empty());
+    parser.reset();
+    REQUIRE(parser.feed("me={line=\"7\"}\n").empty());
+  }
+
+  SUBCASE("parse_record")
+  {
+    char                      type;
+    std::string               record_class;
+    wex::mi_parser::results_t r;
+
+    REQUIRE(!wex::mi_parser::parse_record("(gdb) ", type, record_class, r));
+    REQUIRE(!wex::mi_parser::parse_record("hello", type, record_class, r));
+    REQUIRE(!wex::mi_parser::parse_record(
+      "^done,value=\"42",
+      type,
+      record_class,
+      r));
+
+    REQUIRE(wex::mi_parser::parse_record(
+      "^done,stack=[frame={level=\"0\",line=\"3\"},"
+      "frame={level=\"1\",line=\"9\"}],names=[\"a\",\"b\"]",
+      type,
+      record_class,
+      r));
+    REQUIRE(type == '^');
+    REQUIRE(record_class == "done");
+    REQUIRE(r["stack.0.frame.line"] == "3");
+    REQUIRE(r["stack.1.frame.line"] == "9");
+    REQUIRE(r["names.1"] == "b");
+
+    REQUIRE(wex::mi_parser::parse_record(
+      "~\"tab\\there\\n\"",
+      type,
+      record_class,
+      r));
+    REQUIRE(type == '~');
+    REQUIRE(record_class == "tab\there\n");
+  }
+}
+
+TEST_SUITE_END();
@@ -6,6 +6,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <chrono>
+#include <thread>
 #include <wex/factory/frd.h>
 #include <wex/stream.h>
 
@@ -49,12 +50,53 @@ TEST_CASE("wex::stream_statistics")
   REQUIRE(ss.get().empty());
   REQUIRE(ss.get("xx") == 0);
 
+  // An unknown key is not interned by get.
+  const auto id(wex::stream_statistics::key_id("test-stream-key-1"));
+  REQUIRE(ss.get("test-stream-key-unknown") == 0);
+  REQUIRE(wex::stream_statistics::key_id("test-stream-key-2") == id + 1);
+
   wex::stream_statistics ss2;
   REQUIRE(ss2.get().empty());
 
   ss += ss2;
 
   REQUIRE(ss.get().empty());
+  REQUIRE(ss.empty());
+
+  std::vector<std::thread> v;
+
+  for (int i = 0; i < 4; i++)
+  {
+    v.emplace_back(
+      [&ss]
+      {
+        for (int j = 0; j < 1000; j++)
+        {
+          ss.inc_actions_completed();
+        }
+
+        ss.inc_actions();
+      });
+  }
+
+  for (auto& t : v)
+  {
+    t.join();
+  }
+
+  REQUIRE(ss.get("Actions Completed") == 4000);
+  REQUIRE(ss.get_actions_completed() == 4000);
+  REQUIRE(ss.get("Files") == 4);
+  REQUIRE(ss.set("Files", 1) == 1);
+
+  ss2 = ss;
+  ss2 += ss;
+  REQUIRE(ss2.get("Actions Completed") == 8000);
+  REQUIRE(ss2.get_elements().get_items().size() == 2);
+
+  ss.clear();
+  REQUIRE(ss.empty());
+  REQUIRE(ss.get("Files") == 0);
 }
 
 TEST_CASE("wex::stream")
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      data/test-csv.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <wex/data/csv.h>
+
+#include "test.h"
+
+TEST_CASE("wex::data::csv")
+{
+  SUBCASE("constructor")
+  {
+    wex::data::csv csv;
+
+    REQUIRE(csv.delimiter() == ',');
+    REQUIRE(!csv.gzip());
+    REQUIRE(csv.header());
+    REQUIRE(csv.quote() == '"');
+    REQUIRE(csv.quoting() == wex::data::csv::QUOTE_MINIMAL);
+  }
+
+  SUBCASE("set")
+  {
+    const auto csv(wex::data::csv()
+                     .delimiter('\t')
+                     .gzip(true)
+                     .header(false)
+                     .quote('\'')
+                     .quoting(wex::data::csv::QUOTE_NONE));
+
+    REQUIRE(csv.delimiter() == '\t');
+    REQUIRE(csv.gzip());
+    REQUIRE(!csv.header());
+    REQUIRE(csv.quote() == '\'');
+    REQUIRE(csv.quoting() == wex::data::csv::QUOTE_NONE);
+  }
+}
@@ -6,6 +6,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "../test.h"
+#include <chrono>
 #include <wex/blame.h>
 #include <wex/config.h>
 
@@ -65,5 +66,26 @@ TEST_CASE("wex::blame")
     wex::config("blame", "author").set(false);
     REQUIRE(
       std::get<1>(blame.get(text)).find("A unknown user") == std::string::npos);
+
+    // A copy uses the same compiled format, and the dates
+    // of each commit are parsed once.
+    const wex::blame copy(blame);
+    const auto       start = std::chrono::system_clock::now();
+
+    for (int i = 0; i < 30000; i++)
+    {
+      REQUIRE(std::get<3>(copy.get(text)) == 14);
+    }
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now() - start);
+    MESSAGE("blame 30000 lines: " << ms.count() << " ms");
+  }
+
+  SUBCASE("invalid format")
+  {
+    pugi::xml_document doc;
+    REQUIRE(doc.load_string("<vcs name=\"git\" blame-format=\"(x\"></vcs>"));
+    REQUIRE(!std::get<0>(wex::blame(doc.document_element()).get("x")));
   }
 }
@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      test-executor.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <wex/factory/executor.h>
+
+#include "../test.h"
+
+TEST_CASE("wex::factory::executor")
+{
+  SUBCASE("get")
+  {
+    REQUIRE(wex::factory::executor::get() != nullptr);
+    REQUIRE(wex::factory::executor::get()->get_max_children() >= 2);
+  }
+
+#ifndef __WXMSW__
+  wex::factory::executor executor(2, 2);
+
+  REQUIRE(executor.get_max_children() == 2);
+  REQUIRE(executor.get_queued() == 0);
+  REQUIRE(executor.get_running() == 0);
+  REQUIRE(executor.get_timings().empty());
+
+  SUBCASE("system")
+  {
+    std::string out, err;
+
+    REQUIRE(executor.system("sort", "b\na\n", out, err) == 0);
+    REQUIRE(out == "a\nb\n");
+    REQUIRE(err.empty());
+
+    REQUIRE(executor.system("ls", std::string(10000000, 'x'), out, err) == 0);
+
+    REQUIRE(executor.system("xxxx", std::string(), out, err) != 0);
+    REQUIRE(out.empty());
+    REQUIRE(!err.empty());
+
+    REQUIRE(executor.get_timings().at("sort").count == 1);
+    REQUIRE(executor.get_timings().at("xxxx").failed == 1);
+  }
+
+  SUBCASE("system-while-busy")
+  {
+    std::atomic<int> done{0};
+
+    for (int i = 0; i < 4; i++)
+    {
+      executor.submit(
+        "sleep 1",
+        std::string(),
+        [&](int, const std::string&, const std::string&)
+        {
+          done++;
+        });
+    }
+
+    // a sync system is not queued behind the submitted jobs
+    std::string out, err;
+    const auto  start = std::chrono::steady_clock::now();
+    REQUIRE(executor.system("echo hello", std::string(), out, err) == 0);
+    REQUIRE(out == "hello\n");
+    REQUIRE(
+      std::chrono::steady_clock::now() - start <
+      std::chrono::milliseconds(500));
+    REQUIRE(executor.get_queued() == 2);
+
+    // and can be used from a callback
+    std::atomic<int> code{-1};
+
+    executor.submit(
+      "true",
+      std::string(),
+      [&](int, const std::string&, const std::string&)
+      {
+        std::string o, e;
+        code = executor.system("echo callback", std::string(), o, e);
+      });
+
+    for (int i = 0; i < 500 && (done < 4 || code == -1); i++)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(done == 4);
+    REQUIRE(code == 0);
+  }
+
+  SUBCASE("submit")
+  {
+    std::atomic<int> done{0}, failed{0};
+
+    for (int i = 0; i < 10; i++)
+    {
+      executor.submit(
+        "sleep 0.01",
+        std::string(),
+        [&](int ec, const std::string&, const std::string&)
+        {
+          failed += (ec != 0 ? 1 : 0);
+          done++;
+        });
+    }
+
+    // excess work is queued
+    REQUIRE(executor.get_running() <= 2);
+    REQUIRE(executor.get_queued() > 0);
+
+    const auto& job = executor.submit(
+      "sleep 10",
+      std::string(),
+      [&](int ec, const std::string&, const std::string&)
+      {
+        failed += (ec != 0 ? 1 : 0);
+        done++;
+      });
+
+    executor.cancel(job);
+
+    for (int i = 0; i < 500 && done < 11; i++)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(done == 11);
+    REQUIRE(failed == 1);
+    REQUIRE(executor.get_queued() == 0);
+
+    const auto timing(executor.get_timings().at("sleep"));
+    REQUIRE(timing.count == 10);
+    REQUIRE(timing.failed == 0);
+    REQUIRE(timing.max >= std::chrono::milliseconds(10));
+    REQUIRE(timing.total >= 10 * std::chrono::milliseconds(10));
+  }
+
+  SUBCASE("cancel-running")
+  {
+    std::atomic<int> done{0};
+    int              code = 0;
+
+    const auto& job = executor.submit(
+      "sleep 10",
+      std::string(),
+      [&](int ec, const std::string&, const std::string&)
+      {
+        code = ec;
+        done++;
+      });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    executor.cancel(job);
+
+    for (int i = 0; i < 500 && done == 0; i++)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(done == 1);
+    REQUIRE(code != 0);
+  }
+#endif
+}
@@ -5,6 +5,9 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <chrono>
+#include <thread>
+#include <wex/defs.h>
 #include <wex/factory/process.h>
 
 #include "../test.h"
@@ -51,6 +54,87 @@ TEST_CASE("wex::factory::process")
       process.stop();
       REQUIRE(!process.is_running());
     }
+
+    SUBCASE("output")
+    {
+      std::string text;
+      int         events = 0;
+
+      out.Bind(
+        wxEVT_MENU,
+        [&](wxCommandEvent& event)
+        {
+          text += event.GetString();
+          events++;
+        },
+        wex::ID_SHELL_APPEND);
+
+      REQUIRE(process.async_system("seq 1 100000"));
+
+      for (int i = 0; i < 500 && text.find("\n100000\n") == std::string::npos;
+           i++)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        out.ProcessPendingEvents();
+      }
+
+      // The output is coalesced, and not posted for each line.
+      REQUIRE(text.find("\n100000\n") != std::string::npos);
+      REQUIRE(text.find("1\n2\n3\n") == 0);
+      REQUIRE(events < 1000);
+    }
+
+    SUBCASE("round-trip")
+    {
+      // Uses cat as a stand in for the debugger.
+      wxEvtHandler dbg;
+      std::string  text;
+
+      dbg.Bind(
+        wxEVT_MENU,
+        [&](wxCommandEvent& event)
+        {
+          text += event.GetString();
+        },
+        wex::ID_DEBUG_STDOUT);
+
+      process.set_handler_dbg(&dbg);
+      REQUIRE(process.async_system("cat"));
+      REQUIRE(process.is_debug());
+
+      const int  max   = 100;
+      const auto start = std::chrono::steady_clock::now();
+
+      for (int i = 0; i < max; i++)
+      {
+        const std::string command("print " + std::to_string(i) + "\n");
+
+        REQUIRE(process.write(command.substr(0, command.size() - 1)));
+
+        // Spin instead of sleeping, so the round-trip is not
+        // rounded up to the sleep time.
+        for (const auto until =
+               std::chrono::steady_clock::now() + std::chrono::seconds(1);
+             text.find(command) == std::string::npos &&
+             std::chrono::steady_clock::now() < until;)
+        {
+          std::this_thread::yield();
+          dbg.ProcessPendingEvents();
+        }
+
+        REQUIRE(text.find(command) != std::string::npos);
+      }
+
+      const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count() /
+                      max;
+
+      MESSAGE("round-trip: " << us << " us");
+      REQUIRE(us < 10000);
+
+      REQUIRE(process.stop());
+    }
   }
 #endif
 
@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      test-substitute-engine.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <wex/factory/stc.h>
+#include <wex/substitute-engine.h>
+
+#include "../test.h"
+
+namespace
+{
+class stc : public wex::factory::stc
+{
+public:
+  stc() { Create(wxTheApp->GetTopWindow(), -1); }
+
+private:
+  const wex::path& path() const override { return m_path; };
+  wex::path        m_path;
+};
+}; // namespace
+
+TEST_CASE("wex::substitute_engine")
+{
+  const wex::substitute_engine::substitute_t vi(
+    wex::substitute_engine::substitute_t()
+      .set(wex::substitute_engine::SUBSTITUTE_MATCH_CASE)
+      .set(wex::substitute_engine::SUBSTITUTE_REGEX)
+      .set(wex::substitute_engine::SUBSTITUTE_VI));
+
+  std::string output;
+
+  SUBCASE("constructor")
+  {
+    REQUIRE(wex::substitute_engine("x", "y").is_ok());
+    REQUIRE(!wex::substitute_engine("(", "y", vi).is_ok());
+    REQUIRE(wex::substitute_engine("", "y").string("xyz", output) == 0);
+    REQUIRE(output == "xyz");
+  }
+
+  SUBCASE("literal")
+  {
+    REQUIRE(wex::substitute_engine("Ab", "X").string("ab cab AB", output) == 3);
+    REQUIRE(output == "X cX X");
+
+    REQUIRE(
+      wex::substitute_engine(
+        "ab",
+        "X",
+        wex::substitute_engine::substitute_t()
+          .set(wex::substitute_engine::SUBSTITUTE_GLOBAL)
+          .set(wex::substitute_engine::SUBSTITUTE_MATCH_WORD))
+        .string("ab cab ab_ ab", output) == 2);
+    REQUIRE(output == "X cab ab_ X");
+  }
+
+  SUBCASE("regex")
+  {
+    REQUIRE(
+      wex::substitute_engine(
+        "(\\w+) (\\w+)",
+        "\\2 \\1\\t",
+        wex::substitute_engine::substitute_t().set(
+          wex::substitute_engine::SUBSTITUTE_REGEX))
+        .string("hello world", output) == 1);
+    REQUIRE(output == "world hello\t");
+  }
+
+  SUBCASE("vi")
+  {
+    // Without global only the first match on each line is replaced.
+    REQUIRE(
+      wex::substitute_engine("tiger", "\\U&&\\L& \\0", vi)
+        .string("tiger tiger\nno\ntiger", output) == 2);
+    REQUIRE(output == "TIGERTIGERtiger tiger tiger\nno\nTIGERTIGERtiger tiger");
+
+    REQUIRE(
+      wex::substitute_engine(
+        "$",
+        "EOL",
+        wex::substitute_engine::substitute_t(vi).set(
+          wex::substitute_engine::SUBSTITUTE_GLOBAL))
+        .string("a\r\nb\n\nc", output) == 4);
+    REQUIRE(output == "aEOL\r\nbEOL\nEOL\ncEOL");
+
+    // With a regex the vi replacement is next expanded as a regex
+    // replacement, the inserted text is kept as is.
+    REQUIRE(
+      wex::substitute_engine("(x+) *(y+)", "\\\\2 \\\\1", vi)
+        .string("we have xxxx yyyy zzzz", output) == 1);
+    REQUIRE(output == "we have yyyy xxxx zzzz");
+
+    REQUIRE(
+      wex::substitute_engine("a\\\\n", "[&]", vi).string("a\\n", output) == 1);
+    REQUIRE(output == "[a\\n]");
+  }
+
+  SUBCASE("positions")
+  {
+    wex::substitute_engine::positions_t positions{3, 9, 0, 30};
+
+    REQUIRE(
+      wex::substitute_engine("tiger", "x")
+        .string("a tiger and tiger\nno\ntiger", output, &positions) == 3);
+    REQUIRE(output == "a x and x\nno\nx");
+    REQUIRE(positions == wex::substitute_engine::positions_t{2, 5, 0, 18});
+  }
+
+  SUBCASE("range")
+  {
+    auto* s = new stc();
+    s->SetText("tiger\ntiger tiger\nlion\n");
+    s->GotoPos(s->GetLength());
+
+    REQUIRE(wex::substitute_engine("tiger", "lion").range(s, 0, 6) == 1);
+    REQUIRE(s->GetText() == "lion\ntiger tiger\nlion\n");
+    REQUIRE(s->GetCurrentPos() == s->GetLength());
+
+    REQUIRE(
+      wex::substitute_engine("tiger", "lion").range(s, 0, s->GetLength()) ==
+      2);
+    REQUIRE(s->GetText() == "lion\nlion lion\nlion\n");
+
+    s->Undo();
+    REQUIRE(s->GetText() == "lion\ntiger tiger\nlion\n");
+
+    REQUIRE(wex::substitute_engine("(", "y", vi).range(s, 0, 6) == -1);
+  }
+}
@@ -7,6 +7,7 @@
 
 #include "../test.h"
 #include <wex/beautify.h>
+#include <wex/text-diff.h>
 
 TEST_CASE("wex::beautify")
 {
@@ -18,4 +19,32 @@ TEST_CASE("wex::beautify")
     REQUIRE(wex::beautify().is_supported(wex::lexer("cpp")));
     REQUIRE(!wex::beautify().list().empty());
   }
+
+  SUBCASE("text_diff")
+  {
+    REQUIRE(wex::text_diff("a\nb\n", "a\nb\n").empty());
+
+    // only the changed lines are replaced
+    const std::string text("a\nb\nc\nd\ne\n"), other("a\nB\nc\nd\nE\nf\n");
+    const auto&       hunks(wex::text_diff(text, other));
+    REQUIRE(hunks.size() == 2);
+    REQUIRE(hunks[0].begin == 2);
+    REQUIRE(hunks[0].end == 4);
+    REQUIRE(other.substr(hunks[0].other_begin, 2) == "B\n");
+
+    std::string result(text);
+
+    for (auto it = hunks.rbegin(); it != hunks.rend(); ++it)
+    {
+      result.replace(
+        it->begin,
+        it->end - it->begin,
+        other.substr(it->other_begin, it->other_end - it->other_begin));
+    }
+
+    REQUIRE(result == other);
+
+    // too many differences give one hunk
+    REQUIRE(wex::text_diff(text, other, 1).size() == 1);
+  }
 }
@@ -5,6 +5,7 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <wex/config.h>
 #include <wex/shell.h>
 
 #include "test.h"
@@ -93,6 +94,21 @@ TEST_CASE("wex::shell")
   REQUIRE(shell->get_text().find("aaa") != std::string::npos);
   REQUIRE(shell->get_text().find("bbb") == std::string::npos);
 
+  // Test scrollback is bounded.
+  wex::config("stc.max.Shell lines").set(100);
+  shell->SetText("");
+  for (int i = 0; i < 1000; i++)
+  {
+    shell->AppendText("line " + std::to_string(i) + "\n");
+  }
+  REQUIRE(shell->GetLineCount() <= 111);
+  REQUIRE(shell->get_text().find("line 999") != std::string::npos);
+  REQUIRE(shell->get_text().find("line 0\n") == std::string::npos);
+  REQUIRE(shell->prompt());
+  process("ccc\r", shell);
+  REQUIRE(shell->get_command() == "ccc");
+  wex::config("stc.max.Shell lines").set(100000);
+
   shell->set_process(nullptr);
 
   shell->DocumentEnd();
@@ -137,6 +137,13 @@ TEST_CASE("wex::stc")
     REQUIRE(!stc->find(std::string("less text")));
     REQUIRE(stc->get_find_string() != "less text");
     REQUIRE(stc->replace_all("%", "percent") == 0);
+
+    // A literal find text spanning lines.
+    wex::find_replace_data::get()->set_regex(false);
+    stc->set_text("one\ntwo\nthree");
+    stc->SelectNone();
+    REQUIRE(stc->replace_all("one\ntwo", "x") == 1);
+    REQUIRE(stc->get_text() == "x\nthree");
   }
 
   SUBCASE("hexmode")
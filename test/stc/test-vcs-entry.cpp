@@ -5,6 +5,8 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <filesystem>
+#include <fstream>
 #include <wex/defs.h>
 #include <wex/vcs-entry.h>
 
@@ -72,6 +74,60 @@ TEST_CASE("wex::vcs_entry")
     other->show_output();
 #endif
   }
+
+  SUBCASE("get_branch")
+  {
+    pugi::xml_document doc;
+    REQUIRE(doc.load_string("<vcs name=\"git\" admin-dir=\".git\"></vcs>"));
+    const wex::vcs_entry entry(doc.document_element());
+
+    // The branch is read from the git metadata.
+    const std::filesystem::path dir("vcs-entry-git");
+    std::filesystem::create_directories(dir / ".git" / "refs" / "heads");
+    std::filesystem::create_directories(dir / "src");
+    std::ofstream(dir / ".git" / "HEAD") << "ref: refs/heads/feature/x\n";
+    REQUIRE(entry.get_branch((dir / "src").string()).empty());
+
+    std::ofstream(dir / ".git" / "packed-refs")
+      << "# pack-refs with: peeled\n0123 refs/heads/feature/x\n";
+    REQUIRE(entry.get_branch((dir / "src").string()) == "feature/x");
+
+    // Checking out another branch modifies HEAD.
+    std::ofstream(dir / ".git" / "refs" / "heads" / "main") << "0123\n";
+    std::ofstream(dir / ".git" / "HEAD") << "ref: refs/heads/main\n";
+    std::filesystem::last_write_time(
+      dir / ".git" / "HEAD",
+      std::filesystem::last_write_time(dir / ".git" / "HEAD") +
+        std::chrono::seconds(1));
+    REQUIRE(entry.get_branch((dir / "src").string()) == "main");
+
+    std::filesystem::remove_all(dir);
+  }
+
+#ifndef __WXMSW__
+  SUBCASE("blame")
+  {
+    pugi::xml_document doc;
+    REQUIRE(doc.load_string("<vcs name=\"git\" admin-dir=\".git\">"
+                            "  <commands>"
+                            "     <command> blame </command>"
+                            "  </commands>"
+                            "</vcs>"));
+
+    wex::vcs_entry entry(doc.document_element());
+    REQUIRE(entry.get_command().is_blame());
+
+    const auto wd(wex::test::get_path().string());
+
+    // The second blame on the same revision is taken from the cache.
+    REQUIRE(entry.execute("\"test.h\"", wex::lexer(), wd));
+    const auto out(entry.get_stdout());
+    REQUIRE(!out.empty());
+    REQUIRE(entry.execute("\"test.h\"", wex::lexer(), wd));
+    REQUIRE(entry.get_stdout() == out);
+    REQUIRE(!entry.execute("\"xxx.h\"", wex::lexer(), wd));
+  }
+#endif
 }
 
 TEST_SUITE_END();
@@ -5,9 +5,17 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
 #include <vector>
 #include <wex/config.h>
+#include <wex/factory/executor.h>
+#include <wex/interruptible.h>
 #include <wex/menu.h>
+#include <wex/process.h>
+#include <wex/vcs-batch.h>
 #include <wex/vcs.h>
 
 #include "../test.h"
@@ -25,8 +33,133 @@ TEST_CASE("wex::vcs")
     REQUIRE(wex::vcs::dir_exists(file));
     REQUIRE(!wex::vcs::empty());
     REQUIRE(wex::vcs::size() > 0);
+
+    // The toplevel is cached, also if there is none,
+    // loading the document clears the cache.
+    const std::filesystem::path dir(
+      std::filesystem::temp_directory_path() / "wex-vcs-toplevel");
+    std::filesystem::create_directory(dir);
+    REQUIRE(!wex::vcs::dir_exists(wex::path(dir)));
+    std::filesystem::create_directory(dir / ".git");
+    REQUIRE(!wex::vcs::dir_exists(wex::path(dir)));
+    REQUIRE(wex::vcs::load_document());
+    REQUIRE(wex::vcs::dir_exists(wex::path(dir)));
+    std::filesystem::remove_all(dir);
+  }
+
+  SUBCASE("batch")
+  {
+    wex::vcs vcs(std::vector<wex::path>{file}, 3);
+
+    const std::vector<wex::path> files{file, file, file, file};
+
+    REQUIRE(wex::vcs_batch::max_command_size() > 0);
+
+    // add is not a per file command, so all files are used
+    // as arguments, if the command line is not too long
+    const wex::vcs_batch batch(vcs.entry(), files);
+    REQUIRE(!batch.is_parallel());
+    REQUIRE(batch.jobs().size() == 1);
+    REQUIRE(batch.jobs().front().files.size() == files.size());
+    REQUIRE(batch.jobs().front().exe.find(file.string()) != std::string::npos);
+
+    const auto size(vcs.entry().command_line().size());
+    const wex::vcs_batch split(
+      vcs.entry(),
+      files,
+      size + 2 * (file.string().size() + 3));
+    REQUIRE(split.jobs().size() == 2);
+
+    for (const auto& job : split.jobs())
+    {
+      REQUIRE(job.files.size() == 2);
+      REQUIRE(job.wd == file.parent_path());
+    }
+
+    REQUIRE(!wex::vcs_batch(vcs.entry(), {}).execute(nullptr));
+  }
+
+#ifndef __WXMSW__
+  SUBCASE("batch-in-flight")
+  {
+    pugi::xml_document doc;
+    REQUIRE(doc.load_string("<vcs name=\"git\" admin-dir=\".git\">"
+                            "  <commands>"
+                            "     <command> blame </command>"
+                            "  </commands>"
+                            "</vcs>"));
+
+    const wex::vcs_entry         entry(doc.document_element());
+    const std::vector<wex::path> files(20, file);
+    const wex::vcs_batch         batch(entry, files);
+    REQUIRE(batch.is_parallel());
+    REQUIRE(wex::vcs_batch::max_parallel() >= 1);
+    REQUIRE(
+      wex::vcs_batch::max_parallel() <
+      std::max<size_t>(2, wex::factory::executor::get()->get_max_children()));
+
+    bool done = false;
+
+    REQUIRE(batch.execute(
+      nullptr,
+      [&](const wex::vcs_entry&)
+      {
+        done = true;
+      }));
+
+    // the batch leaves a child for others, and a sync process
+    // is not queued behind it
+    REQUIRE(
+      wex::factory::executor::get()->get_running() <=
+      wex::vcs_batch::max_parallel());
+
+    wex::process process;
+    REQUIRE(process.system("echo hello") == 0);
+    REQUIRE(process.get_stdout() == "hello\n");
+
+    for (int i = 0; i < 1000 && !done; i++)
+    {
+      wxYield();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(done);
   }
 
+  SUBCASE("batch-cancel")
+  {
+    pugi::xml_document doc;
+    REQUIRE(doc.load_string("<vcs name=\"git\" admin-dir=\".git\">"
+                            "  <commands>"
+                            "     <command> blame </command>"
+                            "  </commands>"
+                            "</vcs>"));
+
+    const wex::vcs_entry entry(doc.document_element());
+    bool                 done = false;
+
+    REQUIRE(wex::vcs_batch(entry, std::vector<wex::path>(20, file))
+              .execute(
+                nullptr,
+                [&](const wex::vcs_entry&)
+                {
+                  done = true;
+                }));
+
+    // the running processes are terminated, without waiting for a result
+    REQUIRE(wex::interruptible::cancel());
+
+    for (int i = 0; i < 1000 && !done; i++)
+    {
+      wxYield();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(done);
+    REQUIRE(wex::factory::executor::get()->get_running() == 0);
+  }
+#endif
+
   SUBCASE("others")
   {
     // In wex::app the vcs is loaded, so current vcs is known,
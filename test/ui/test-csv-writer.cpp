@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      test-csv-writer.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <wex/csv-writer.h>
+#include <wx/wfstream.h>
+#include <wx/zstream.h>
+
+#include "test.h"
+
+// Writes a header and two rows, and returns the file contents.
+std::string csv_write_read(const wex::data::csv& data)
+{
+  const wex::path p(
+    data.gzip() ? "test-csv-writer.csv.gz" : "test-csv-writer.csv");
+
+  {
+    wex::csv_writer out(p, data);
+    REQUIRE(out.is_ok());
+
+    out.header({"id", "name"});
+
+    out.add("1");
+    out.add("plain");
+    out.end_row();
+
+    out.add("2");
+    out.add("say \"hi\", bye\nagain\t\\");
+    out.end_row();
+
+    REQUIRE(out.close());
+    REQUIRE(out.bytes() > 0);
+  }
+
+  std::string text;
+
+  if (data.gzip())
+  {
+    wxFileInputStream file(p.string());
+    wxZlibInputStream zlib(file, wxZLIB_GZIP);
+    char              buffer[1024];
+
+    while (zlib.Read(buffer, sizeof(buffer)).LastRead() > 0)
+    {
+      text.append(buffer, zlib.LastRead());
+    }
+  }
+  else
+  {
+    std::stringstream ss;
+    ss << std::ifstream(p.string()).rdbuf();
+    text = ss.str();
+  }
+
+  remove(p.string().c_str());
+
+  return text;
+}
+
+TEST_CASE("wex::csv_writer")
+{
+  SUBCASE("minimal")
+  {
+    REQUIRE(
+      csv_write_read(wex::data::csv()) ==
+      "id,name\n1,plain\n2,\"say \"\"hi\"\", bye\nagain\t\\\"\n");
+  }
+
+  SUBCASE("all")
+  {
+    const auto data(
+      wex::data::csv().quoting(wex::data::csv::QUOTE_ALL).quote('\''));
+
+    REQUIRE(
+      csv_write_read(data) ==
+      "'id','name'\n'1','plain'\n'2','say \"hi\", bye\nagain\t\\'\n");
+  }
+
+  SUBCASE("none")
+  {
+    // Escaped, so each row stays on one line.
+    const auto tsv(wex::data::csv()
+                     .delimiter('\t')
+                     .header(false)
+                     .quoting(wex::data::csv::QUOTE_NONE));
+
+    REQUIRE(
+      csv_write_read(tsv) == "1\tplain\n2\tsay \"hi\", bye\\nagain\\t\\\\\n");
+
+    REQUIRE(
+      csv_write_read(wex::data::csv().quoting(wex::data::csv::QUOTE_NONE)) ==
+      "id,name\n1,plain\n2,say \"hi\"\\, bye\\nagain\t\\\\\n");
+  }
+
+  SUBCASE("gzip")
+  {
+    REQUIRE(
+      csv_write_read(wex::data::csv().gzip(true)) ==
+      "id,name\n1,plain\n2,\"say \"\"hi\"\", bye\nagain\t\\\"\n");
+  }
+}
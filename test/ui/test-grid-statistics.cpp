@@ -53,6 +53,15 @@ TEST_CASE("wex::grid_statistics")
   REQUIRE(statistics1->show() == grid1);
   REQUIRE(statistics2->set("xx", 10) == 10);
 
+  // The value is shown by the timer.
+  for (int i = 0; i < 100 && statistics2->GetCellValue(0, 1) != "10"; i++)
+  {
+    wxMilliSleep(10);
+    wxYield();
+  }
+
+  REQUIRE(statistics2->GetCellValue(0, 1) == "10");
+
   statistics2->clear();
   REQUIRE(statistics2->inc("xx") == 1);
   REQUIRE(statistics2->get_items().size() == 1);
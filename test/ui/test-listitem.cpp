@@ -46,6 +46,19 @@ TEST_CASE("wex::listitem")
     lv->get_item_text(0, _("File Name").ToStdString()).find("test-special.h") !=
     std::string::npos);
 
+  // The other attributes are set from the event loop, also after sorting.
+  for (int i = 0;
+       i < 100 && lv->get_item_text(0, _("Size").ToStdString()).empty();
+       i++)
+  {
+    wxMilliSleep(10);
+    wxYield();
+  }
+
+  REQUIRE(lv->get_item_text(0, _("Type").ToStdString()) == ".h");
+  REQUIRE(!lv->get_item_text(0, _("Size").ToStdString()).empty());
+  REQUIRE(!lv->get_item_text(1, _("Modified").ToStdString()).empty());
+
   wex::listitem item(lv, wex::path("./test.h"));
   item.insert();
   REQUIRE(item.path().filename() == "test.h");
@@ -58,4 +71,26 @@ TEST_CASE("wex::listitem")
   item.set_item("xx", "yy");
   item.update();
   item.erase();
+
+  // A path string is inserted without a stat, if it does not exist
+  // the path as specified is shown later on.
+  wex::listitem missing(lv, std::string("./xxx/missing.h"));
+  REQUIRE(missing.file() == "./xxx/missing.h");
+  missing.insert();
+  const auto no(missing.GetId());
+  REQUIRE(lv->get_item_text(no, _("File Name").ToStdString()) == "missing.h");
+
+  for (int i = 0;
+       i < 100 && lv->get_item_text(no, _("File Name").ToStdString()) !=
+                    "./xxx/missing.h";
+       i++)
+  {
+    wxMilliSleep(10);
+    wxYield();
+  }
+
+  REQUIRE(
+    lv->get_item_text(no, _("File Name").ToStdString()) == "./xxx/missing.h");
+  REQUIRE(lv->get_item_text(no, _("In Folder").ToStdString()).empty());
+  REQUIRE(wex::listitem(lv, no).file() == "./xxx/missing.h");
 }
@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      test-listview-store.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <wex/listview-store.h>
+
+#include "test.h"
+
+TEST_CASE("wex::listview_store")
+{
+  wex::listview_store store;
+
+  for (int i = 0; i < 3; i++)
+  {
+    store.append_column();
+  }
+
+  REQUIRE(store.columns() == 3);
+  REQUIRE(store.size() == 0);
+  REQUIRE(store.get(0, 0).empty());
+
+  SUBCASE("insert")
+  {
+    REQUIRE(store.insert({"test.h", "1", "line"}) == 0);
+    REQUIRE(store.insert({"test.h", "2"}) == 1);
+    REQUIRE(store.insert({"other.h", "3", "x"}, 0) == 0);
+    REQUIRE(store.size() == 3);
+
+    REQUIRE(store.get(0, 0) == "other.h");
+    REQUIRE(store.get(1, 0) == "test.h");
+    REQUIRE(store.get(1, 2) == "line");
+    REQUIRE(store.get(2, 0) == "test.h");
+    REQUIRE(store.get(2, 2).empty());
+    REQUIRE(store.get(3, 0).empty());
+    REQUIRE(store.get(0, 3).empty());
+
+    REQUIRE(store.get_image(0) == -1);
+    store.set_image(0, 5);
+    REQUIRE(store.get_image(0) == 5);
+    REQUIRE(store.get_data(1) == 0);
+    store.set_data(1, 1);
+    REQUIRE(store.get_data(1) == 1);
+  }
+
+  SUBCASE("shared")
+  {
+    const std::string path(1000, 'x');
+
+    store.insert({path, "1"});
+    const auto memory = store.memory();
+
+    for (int i = 2; i < 100; i++)
+    {
+      store.insert({path, std::to_string(i)});
+    }
+
+    // the path is only stored once
+    REQUIRE(store.memory() < memory + 99 * 100);
+    REQUIRE(store.get(98, 0) == path);
+    REQUIRE(store.get(98, 1) == "99");
+  }
+
+  SUBCASE("set")
+  {
+    store.insert({"a", "1"});
+    store.insert({"a", "2"});
+
+    REQUIRE(store.set(0, 0, "b"));
+    REQUIRE(store.get(0, 0) == "b");
+    REQUIRE(store.get(1, 0) == "a");
+    REQUIRE(store.set(1, 2, "c"));
+    REQUIRE(store.get(1, 2) == "c");
+    REQUIRE(!store.set(2, 0, "c"));
+    REQUIRE(!store.set(0, 3, "c"));
+  }
+
+  SUBCASE("erase")
+  {
+    for (int i = 0; i < 10; i++)
+    {
+      store.insert({std::to_string(i), std::string(100, 'a' + i)});
+    }
+
+    store.erase({9, 0, 5, 5, 20});
+
+    REQUIRE(store.size() == 7);
+    REQUIRE(store.get(0, 0) == "1");
+    REQUIRE(store.get(4, 0) == "6");
+    REQUIRE(store.get(6, 0) == "8");
+    REQUIRE(store.get(6, 1) == std::string(100, 'i'));
+
+    store.erase({0, 1, 2, 3, 4, 5});
+    REQUIRE(store.size() == 1);
+    REQUIRE(store.get(0, 1) == std::string(100, 'i'));
+
+    store.clear();
+    REQUIRE(store.size() == 0);
+    REQUIRE(store.columns() == 3);
+  }
+
+  SUBCASE("find")
+  {
+    store.insert({"test.h", "1", "some line"});
+    store.insert({"test.h", "2", "other LINE"});
+    store.insert({"special.h", "3", "x"});
+
+    REQUIRE(store.find("line", 0) == 0);
+    REQUIRE(store.find("line", 1) == 1);
+    REQUIRE(store.find("line", 1, true, true) == -1);
+    REQUIRE(store.find("LINE", 2, false, true) == 1);
+    REQUIRE(store.find("SPECIAL", 0) == 2);
+    REQUIRE(store.find("special", 0, false) == -1);
+    REQUIRE(store.find("3", 0, true, false, true) == 2);
+    REQUIRE(store.find("test", 0, true, false, true) == -1);
+    REQUIRE(store.find("xyz", 0) == -1);
+    REQUIRE(store.find("", 0) == -1);
+    REQUIRE(store.find("x", 5) == -1);
+
+    REQUIRE(store.set(0, 2, "changed"));
+    REQUIRE(store.find("some", 0) == -1);
+    REQUIRE(store.find("changed", 0) == 0);
+
+    store.reorder({2, 1, 0});
+    REQUIRE(store.find("changed", 0) == 2);
+
+    store.erase({0});
+    REQUIRE(store.find("special", 0) == -1);
+    REQUIRE(store.find("changed", 0) == 1);
+  }
+
+  SUBCASE("reorder")
+  {
+    store.insert({"x", "1"});
+    store.insert({"y", "2"});
+    store.insert({"z", "3"});
+    store.set_data(2, 1);
+
+    store.reorder({2, 0, 1});
+
+    REQUIRE(store.get(0, 0) == "z");
+    REQUIRE(store.get(1, 0) == "x");
+    REQUIRE(store.get(2, 1) == "2");
+    REQUIRE(store.get_data(0) == 1);
+
+    store.append_column();
+    REQUIRE(store.get(0, 3).empty());
+    REQUIRE(store.set(0, 3, "new"));
+    REQUIRE(store.get(0, 3) == "new");
+  }
+
+  SUBCASE("reorder-shared")
+  {
+    const std::string p(100, 'p'), q(100, 'q');
+
+    for (int i = 0; i < 3; i++)
+    {
+      store.insert({p, std::to_string(i)});
+    }
+
+    for (int i = 3; i < 6; i++)
+    {
+      store.insert({q, std::to_string(i)});
+    }
+
+    // Cells sharing text are no longer adjacent.
+    store.reorder({0, 3, 1, 4, 2, 5});
+    store.erase({0, 1, 2, 3});
+
+    REQUIRE(store.size() == 2);
+    REQUIRE(store.get(0, 0) == p);
+    REQUIRE(store.get(0, 1) == "2");
+    REQUIRE(store.get(1, 0) == q);
+    REQUIRE(store.get(1, 1) == "5");
+
+    REQUIRE(store.set(0, 0, q));
+    REQUIRE(store.set(1, 0, p));
+    REQUIRE(store.get(0, 0) == q);
+    REQUIRE(store.get(1, 0) == p);
+  }
+}
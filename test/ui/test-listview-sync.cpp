@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// Name:      test-listview-sync.cpp
+// Purpose:   Implementation for wex unit testing
+// Author:    Anton van Wezenbeek
+// Copyright: (c) 2021 Anton van Wezenbeek
+////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <wex/listitem.h>
+#include <wex/listview-sync.h>
+#include <wex/listview.h>
+
+#include "test.h"
+
+namespace fs = std::filesystem;
+
+TEST_CASE("wex::listview_sync")
+{
+  const fs::path dir(fs::temp_directory_path() / "wex-listview-sync");
+  fs::create_directories(dir / "a");
+  fs::create_directories(dir / "b");
+  std::ofstream(dir / "a" / "file.txt") << "a\n";
+  std::ofstream(dir / "b" / "file.txt") << "b\n";
+
+  auto* lv =
+    new wex::listview(wex::data::listview().type(wex::data::listview::FILE));
+  frame()->pane_add(lv);
+
+  wex::listitem(lv, wex::path(dir / "a" / "file.txt")).insert();
+  wex::listitem(lv, wex::path(dir / "b" / "file.txt")).insert();
+
+  const auto modified(_("Modified").ToStdString());
+
+  // Waits for the attributes that are set in the background.
+  for (int i = 0; i < 100 && lv->get_item_text(1, modified).empty(); i++)
+  {
+    wxMilliSleep(10);
+    wxYield();
+  }
+
+  REQUIRE(lv->GetItemCount() == 2);
+  REQUIRE(!lv->get_item_text(1, modified).empty());
+
+  SUBCASE("update")
+  {
+    const auto col(lv->find_column(modified));
+    REQUIRE(lv->set_item(0, col, "x"));
+    REQUIRE(lv->set_item(1, col, "x"));
+
+    // Touching a file only updates the row of that file.
+    std::ofstream(dir / "a" / "file.txt", std::ios::app) << "more\n";
+    fs::last_write_time(
+      dir / "a" / "file.txt",
+      fs::last_write_time(dir / "a" / "file.txt") + std::chrono::seconds(10));
+
+    for (int i = 0; i < 300 && lv->get_item_text(0, modified) == "x"; i++)
+    {
+      wxMilliSleep(10);
+      wxYield();
+    }
+
+    REQUIRE(lv->get_item_text(0, modified) != "x");
+    REQUIRE(lv->get_item_text(1, modified) == "x");
+  }
+
+  SUBCASE("dirs")
+  {
+    wex::listview_sync sync(lv);
+
+    sync.changed();
+    wxYield();
+    REQUIRE(sync.dirs().size() == 2);
+
+    // A folder without items is no longer watched.
+    lv->DeleteItem(1);
+    sync.changed();
+    wxYield();
+    REQUIRE(sync.dirs().size() == 1);
+    REQUIRE(sync.dirs().contains((dir / "a").string()));
+  }
+
+  fs::remove_all(dir);
+}
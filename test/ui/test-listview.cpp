@@ -10,6 +10,7 @@
 #include <wx/wx.h>
 #endif
 #include <wex/defs.h>
+#include <wex/frd.h>
 #include <wex/listview.h>
 
 #include "test.h"
@@ -53,6 +54,7 @@ TEST_CASE("wex::listview")
 
     REQUIRE(lv->find_next("95"));
     REQUIRE(!lv->find_next("test"));
+    REQUIRE(!lv->filter("95"));
 
     REQUIRE(!lv->item_from_text("a new item"));
     REQUIRE(!lv->find_next("another new item"));
@@ -101,8 +103,12 @@ TEST_CASE("wex::listview")
     lv->sort_column_reset();
     REQUIRE(lv->sorted_column_no() == -1);
 
-    lv->SetItem(0, 1, "incorrect date");
+    REQUIRE(lv->sort_column("Float", wex::SORT_DESCENDING));
+    REQUIRE(lv->get_item_text(0, "Float") == std::to_string(4.5f));
+
+    lv->SetItem(5, 1, "incorrect date");
     REQUIRE(lv->sort_column("Date"));
+    REQUIRE(lv->get_item_text(0, "Date") == "incorrect date");
   }
 
   SUBCASE("item_from_to_text")
@@ -135,6 +141,62 @@ TEST_CASE("wex::listview")
     }
   }
 
+  SUBCASE("virtual")
+  {
+    auto* lv = new wex::listview(
+      wex::data::listview().type(wex::data::listview::FIND));
+    frame()->pane_add(lv);
+
+    REQUIRE(lv->is_virtual());
+    REQUIRE(static_cast<int>(lv->store().columns()) == lv->GetColumnCount());
+
+    REQUIRE(lv->item_from_text("test.h\ntest-special.h"));
+    REQUIRE(lv->GetItemCount() == 2);
+    REQUIRE(lv->store().size() == 2);
+    REQUIRE(lv->get_item_text(0, _("File Name").ToStdString()) == "test.h");
+    REQUIRE(
+      lv->set_item(1, lv->find_column(_("Line No").ToStdString()), "12"));
+    REQUIRE(!lv->set_item(1, lv->find_column(_("Line No").ToStdString()), "x"));
+    REQUIRE(lv->item_to_text(1).find("12") != std::string::npos);
+    REQUIRE(lv->save().size() == 2);
+
+    REQUIRE(
+      lv->sort_column(_("File Name").ToStdString(), wex::SORT_DESCENDING));
+    REQUIRE(lv->get_item_text(0, _("File Name").ToStdString()) == "test.h");
+    REQUIRE(lv->find_next("special"));
+    REQUIRE(lv->GetFirstSelected() == 1);
+
+    wex::find_replace_data::get()->set_find_string("test-.*\\.h");
+    wex::find_replace_data::get()->set_regex(true);
+    lv->Select(1, false);
+    REQUIRE(lv->find_next("test-.*\\.h"));
+    REQUIRE(lv->GetFirstSelected() == 1);
+    REQUIRE(!lv->find_next("xx+yy"));
+    lv->Select(1, false);
+    REQUIRE(lv->find_next("te\\x73t-sp"));
+    REQUIRE(lv->GetFirstSelected() == 1);
+    wex::find_replace_data::get()->set_regex(false);
+
+    REQUIRE(lv->filter("special"));
+    REQUIRE(lv->is_filtered());
+    REQUIRE(lv->GetItemCount() == 1);
+    REQUIRE(
+      lv->get_item_text(0, _("File Name").ToStdString()) == "test-special.h");
+    REQUIRE(lv->filter("*.h"));
+    REQUIRE(lv->GetItemCount() == 2);
+    REQUIRE(
+      lv->sort_column(_("File Name").ToStdString(), wex::SORT_ASCENDING));
+    REQUIRE(
+      lv->get_item_text(0, _("File Name").ToStdString()) == "test-special.h");
+    REQUIRE(lv->filter(std::string()));
+    REQUIRE(!lv->is_filtered());
+    REQUIRE(lv->GetItemCount() == 2);
+
+    lv->clear();
+    REQUIRE(lv->GetItemCount() == 0);
+    REQUIRE(lv->store().size() == 0);
+  }
+
   SUBCASE("TSV")
   {
     auto* lv =
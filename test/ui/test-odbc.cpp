@@ -25,7 +25,7 @@ TEST_CASE("wex::odbc")
   wex::config(_("User")).set();
   wex::config(_("Password")).set();
 
-  wex::odbc odbc;
+  wex::odbc odbc(true);
 
   REQUIRE(!odbc.get_version_info().get().empty());
   REQUIRE(!odbc.datasource().empty());
@@ -41,11 +41,54 @@ TEST_CASE("wex::odbc")
     REQUIRE(odbc.query("select * from one") == 0);
     REQUIRE(odbc.query("select * from one", get_stc(), stopped) == 0);
     REQUIRE(odbc.query("select * from one", grid, stopped) == 0);
+    REQUIRE(!odbc.query_async("select * from one", grid));
+    REQUIRE(
+      odbc.query("select * from one", wex::path("one.csv"), stopped) == 0);
+    REQUIRE(!odbc.query_running());
+    REQUIRE(!odbc.query_cancel());
     REQUIRE(!odbc.logoff());
   }
   else
   {
+    bool stopped = false;
     REQUIRE(odbc.query("select * from one") == 9);
+    REQUIRE(odbc.query("select * from one", grid, stopped) == 9);
+    REQUIRE(grid->GetNumberRows() == 9);
+    REQUIRE(odbc.query("select * from one", grid, stopped, false) == 9);
+    REQUIRE(grid->GetNumberRows() == 18);
+
+    // An async query requires threaded mode.
+    wex::odbc single;
+    single.logon(wex::data::window().button(0));
+    REQUIRE(single.is_connected());
+    REQUIRE(!single.query_async("select * from one", grid));
+    REQUIRE(!single.query_running());
+
+    REQUIRE(odbc.query_async("select * from one", grid));
+    REQUIRE(odbc.query_running());
+    REQUIRE(!odbc.query_async("select * from one", get_stc()));
+
+    for (int i = 0; i < 100 && odbc.query_running(); i++)
+    {
+      wxMilliSleep(10);
+      wxYield();
+    }
+
+    REQUIRE(!odbc.query_running());
+    REQUIRE(odbc.query_rows() == 9);
+    REQUIRE(grid->GetNumberRows() == 9);
+    REQUIRE(!odbc.query_cancel());
+
+    REQUIRE(
+      odbc.query("select * from one", wex::path("one.csv"), stopped) == 9);
+    REQUIRE(
+      odbc.query(
+        "select * from one",
+        wex::path("one.tsv.gz"),
+        stopped,
+        wex::data::csv().delimiter('\t').gzip(true)) == 9);
+    REQUIRE(wex::path("one.tsv.gz").file_exists());
+
     REQUIRE(odbc.logoff());
   }
 #endif
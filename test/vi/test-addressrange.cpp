@@ -121,6 +121,12 @@ TEST_CASE("wex::addressrange")
     REQUIRE(stc->get_line_count() == 8);
     REQUIRE(wex::addressrange(ex, "%").escape("uniq"));
     REQUIRE(stc->get_line_count() == 5);
+
+    // The same output does not change the text.
+    stc->EmptyUndoBuffer();
+    REQUIRE(wex::addressrange(ex, "%").escape("cat"));
+    REQUIRE(stc->get_line_count() == 5);
+    REQUIRE(!stc->CanUndo());
     REQUIRE(wex::addressrange(ex, "%").escape("ls -l"));
 #endif
   }
@@ -5,8 +5,11 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <chrono>
+#include <wex/config.h>
 #include <wex/macro-mode.h>
 #include <wex/macros.h>
+#include <wex/register-file.h>
 #include <wex/vi.h>
 
 #include "test.h"
@@ -91,6 +94,122 @@ TEST_CASE("wex::macros" * doctest::may_fail())
     REQUIRE(!macros.get().empty());
   }
 
+  SUBCASE("compiled")
+  {
+    REQUIRE(macros.set_register('c', ":s/x/y/"));
+
+    const auto compiled(macros.get_macro_compiled("c", vi));
+    REQUIRE(compiled->size() == 1);
+    REQUIRE(compiled->front().type() == wex::macro_command::TYPE_EX_RANGE);
+    REQUIRE(compiled->front().range() == ".");
+    REQUIRE(compiled->front().cmd() == "s");
+    REQUIRE(compiled->front().text() == "/x/y/");
+    REQUIRE(macros.get_macro_compiled("c", vi) == compiled);
+
+    REQUIRE(macros.set_register('c', ":'a,'bd"));
+    REQUIRE(macros.get_macro_compiled("c", vi) != compiled);
+    REQUIRE(
+      macros.get_macro_compiled("c", vi)->front().type() ==
+      wex::macro_command::TYPE_OTHER);
+
+    REQUIRE(macros.set_register('d', "3w"));
+    const auto& motion(macros.get_macro_compiled("d", vi)->front());
+    REQUIRE(motion.type() == wex::macro_command::TYPE_VI_MOTION);
+    REQUIRE(motion.count() == 3);
+    REQUIRE(vi->motion_commands()[motion.motion()].first == "w");
+
+    REQUIRE(macros.set_register('d', "i"));
+    REQUIRE(
+      macros.get_macro_compiled("d", vi)->front().type() ==
+      wex::macro_command::TYPE_OTHER);
+  }
+
+  SUBCASE("compiled playback")
+  {
+    std::string text;
+
+    for (int i = 0; i < 1000; i++)
+    {
+      text += "xxxxx\n";
+    }
+
+    vi->get_stc()->set_text(text);
+    REQUIRE(wex::ex::get_macros().set_register('p', ":s/x/y/"));
+
+    const auto start = std::chrono::system_clock::now();
+    REQUIRE(vi->command(":%@p"));
+    const auto milli = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now() - start);
+
+    CAPTURE(milli.count());
+    REQUIRE(milli.count() < 5000);
+    REQUIRE(vi->get_stc()->get_text().find("y") != std::string::npos);
+  }
+
+  SUBCASE("compiled playback benchmark")
+  {
+    std::string text;
+
+    for (int i = 0; i < 2000; i++)
+    {
+      text += "xxxxx\n";
+    }
+
+    vi->mode().escape();
+    vi->get_stc()->set_text(text);
+
+    auto& m(wex::ex::get_macros());
+    REQUIRE(m.mode().transition("qb", vi) == 2);
+
+    // each playback changes the next line
+    for (const auto& c : {"j", "3l", "k", "j", ":s/x/y/"})
+    {
+      REQUIRE(m.record(c));
+    }
+
+    REQUIRE(m.mode().transition("q", vi) == 1);
+
+    const auto& commands(m.get_macro_commands("b"));
+    const auto  compiled(m.get_macro_compiled("b", vi));
+    REQUIRE(compiled->size() == commands.size());
+
+    // Plays back the macro 1000 times, as 1000@b does, before (each
+    // command parsed) and after (compiled commands), on the same text,
+    // returns the time in us.
+    const auto playback = [&](const auto& v)
+    {
+      vi->get_stc()->set_text(text);
+      vi->get_stc()->DocumentStart();
+
+      bool       ok    = true;
+      const auto start = std::chrono::steady_clock::now();
+
+      for (int i = 0; i < 1000; i++)
+      {
+        for (const auto& c : v)
+        {
+          ok = vi->command(c) && ok;
+        }
+      }
+
+      REQUIRE(ok);
+
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+    };
+
+    const auto before = playback(commands);
+    const auto result(vi->get_stc()->get_text());
+    REQUIRE(result != text);
+    const auto after = playback(*compiled);
+
+    // Timings are only reported, the compiled commands should have
+    // the same result.
+    MESSAGE("1000@b before: " << before << "us after: " << after << "us");
+    REQUIRE(vi->get_stc()->get_text() == result);
+  }
+
   SUBCASE("keysmap") { macros.set_key_map("4", "www"); }
 
   SUBCASE("append")
@@ -150,6 +269,17 @@ TEST_CASE("wex::macros" * doctest::may_fail())
 
     // A second save is not necessary.
     REQUIRE(!macros.save_document());
+
+    // Changes of another instance are kept.
+    wex::macros other;
+    REQUIRE(other.load_document());
+    other.set_abbreviation("OTHER", "other instance");
+    macros.set_abbreviation("THIS", "this instance");
+    REQUIRE(other.save_document());
+    REQUIRE(macros.save_document());
+    REQUIRE(other.load_document());
+    REQUIRE(other.get_abbreviations().count("THIS") == 1);
+    REQUIRE(other.get_abbreviations().count("OTHER") == 1);
   }
 
   SUBCASE("registers")
@@ -168,6 +298,41 @@ TEST_CASE("wex::macros" * doctest::may_fail())
     REQUIRE(macros.get_register('_').empty());
   }
 
+  SUBCASE("registers-large")
+  {
+    const std::string text(2000000, 'x');
+
+    REQUIRE(macros.set_register('l', text));
+    REQUIRE(macros.get_register_file('l') != nullptr);
+    REQUIRE(macros.get_register_file('l')->view() == text);
+    REQUIRE(
+      wex::path(macros.get_register_file('l')->name()).parent_path() ==
+      wex::config::dir().string());
+    REQUIRE(macros.get_register('l') == text);
+    REQUIRE(macros.find("l").empty());
+
+    REQUIRE(macros.copy_register('l', 'm'));
+    REQUIRE(macros.get_register_file('m') == macros.get_register_file('l'));
+
+    REQUIRE(macros.set_register('l', "small"));
+    REQUIRE(macros.get_register_file('l') == nullptr);
+    REQUIRE(macros.get_register('l') == "small");
+    REQUIRE(macros.get_register('m') == text);
+
+    REQUIRE(macros.load_document());
+    REQUIRE(macros.get_register('m') == text);
+
+    // The file is removed when the last reference is gone.
+    auto rf(macros.get_register_file('m'));
+    REQUIRE(rf != nullptr);
+    const wex::path file(rf->name());
+    REQUIRE(macros.set_register('m', std::string()));
+    REQUIRE(macros.get_register_file('m') == nullptr);
+    REQUIRE(file.file_exists());
+    rf.reset();
+    REQUIRE(!wex::path(file.string()).file_exists());
+  }
+
   SUBCASE("abbreviations")
   {
     for (auto& abbrev : get_abbreviations())
@@ -5,6 +5,9 @@
 // Copyright: (c) 2021 Anton van Wezenbeek
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <chrono>
+#include <map>
+#include <sstream>
 #include <vector>
 #include <wex/config.h>
 #include <wex/core.h>
@@ -241,6 +244,64 @@ TEST_CASE("wex::vi")
     REQUIRE(stc->get_line_count() == 1);
   }
 
+  SUBCASE("latency")
+  {
+    std::string text;
+
+    for (int i = 0; i < 100; i++)
+    {
+      text += "first second third fourth\n";
+    }
+
+    stc->set_text(text);
+
+    // histogram of latency per keystroke, bucket is upper bound in us
+    std::map<long, int>            histogram;
+    const std::vector<std::string> keys{
+      "gg", "j", "w", "l", "3w", "b", "h", "e", "k", "0", "$", "j", "x", "u"};
+
+    for (int i = 0; i < 100; i++)
+    {
+      for (const auto& key : keys)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(vi->command(key));
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+        long bucket = 1;
+
+        while (bucket < us)
+        {
+          bucket *= 2;
+        }
+
+        histogram[bucket]++;
+      }
+    }
+
+    std::stringstream ss;
+    const int         half  = keys.size() * 50;
+    int               total = 0, median = 0;
+
+    for (const auto& it : histogram)
+    {
+      ss << "<= " << it.first << "us: " << it.second << "\n";
+
+      if (total < half && total + it.second >= half)
+      {
+        median = it.first;
+      }
+
+      total += it.second;
+    }
+
+    MESSAGE(ss.str());
+    REQUIRE(total == 2 * half);
+    REQUIRE(median < 10000);
+  }
+
   SUBCASE("macro")
   {
     for (const auto& macro : std::vector<std::vector<std::string>>{